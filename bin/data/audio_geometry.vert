@@ -0,0 +1,32 @@
+#version 150
+
+// Places one vertex per sample of row |block| of |samples|, as a tunnel
+// ring (shape 0) or a waveform line (shape 1). Matches PolarLayout and
+// MakeWaveformPolyline() on the CPU.
+uniform mat4 modelViewProjectionMatrix;
+uniform sampler2D samples;
+uniform int block;
+uniform int shape;
+uniform vec3 circle;    // center x, y, radius
+uniform float sweep;
+uniform vec3 line;      // left, right, baseline
+uniform float gain;
+
+in vec4 position;
+
+void main()
+{
+    int count = textureSize(samples, 0).x;
+    int i = gl_VertexID;
+    float value = texelFetch(samples, ivec2(i, block), 0).r;
+
+    vec2 point;
+    if (shape == 0) {
+        float angle = float(i) / float(count) * sweep;
+        point = circle.xy + (circle.z + gain * value) * vec2(cos(angle), sin(angle));
+    }
+    else {
+        point = vec2(line.x + float(i) * (line.y - line.x) / float(count), line.z + gain * value);
+    }
+    gl_Position = modelViewProjectionMatrix * vec4(point, 0.0, 1.0);
+}
@@ -0,0 +1,34 @@
+#version 150
+
+// Linear blend skinning for ofxAssimpModelLoader. Positions and normals
+// are the bind pose; each vertex blends up to 4 matrices from the bone
+// palette, which is the only thing uploaded per frame.
+
+#define MAX_BONES 64
+
+uniform mat4 modelViewMatrix;
+uniform mat4 modelViewProjectionMatrix;
+uniform mat4 bones[MAX_BONES];
+uniform float skinned;
+
+in vec4 position;
+in vec4 normal;
+in vec2 texcoord;
+in vec4 boneIndices;
+in vec4 boneWeights;
+
+out vec3 normalVarying;
+out vec2 texCoordVarying;
+
+void main(){
+    mat4 skin = mat4(1.0);
+    if (skinned > 0.5) {
+        skin = boneWeights.x * bones[int(boneIndices.x)]
+             + boneWeights.y * bones[int(boneIndices.y)]
+             + boneWeights.z * bones[int(boneIndices.z)]
+             + boneWeights.w * bones[int(boneIndices.w)];
+    }
+    texCoordVarying = texcoord;
+    normalVarying = mat3(modelViewMatrix) * (mat3(skin) * normal.xyz);
+    gl_Position = modelViewProjectionMatrix * (skin * vec4(position.xyz, 1.0));
+}
@@ -0,0 +1,33 @@
+#version 150
+
+// Lays out the spectrum history as a heightfield. Each vertex holds a
+// (band, row) pair, row 0 being the newest snapshot; its height comes
+// from the ring texture, where the newest snapshot is row |head|.
+uniform mat4 modelViewProjectionMatrix;
+uniform sampler2D history;
+uniform int head;
+uniform int rows;
+uniform vec2 span;      // x of the first and last band
+uniform vec2 baseline;  // y of silence, height scale
+uniform float depth;
+
+in vec4 position;
+out float age;
+
+void main()
+{
+    ivec2 size = textureSize(history, 0);
+    int band = int(position.x);
+    int row = int(position.y);
+    float magnitude = texelFetch(history, ivec2(band, (head - row + size.y) % size.y), 0).r;
+
+    // Snapshots start |depth| back and dark, and move forward and
+    // brighten until they drop off the front, as the per-snapshot meshes
+    // used to.
+    age = float(row + 1) / float(rows);
+    vec4 vertex = vec4(mix(span.x, span.y, float(band) / float(size.x - 1)),
+                       baseline.x - baseline.y * sqrt(25.0 * magnitude),
+                       -depth * (1.0 - age),
+                       1.0);
+    gl_Position = modelViewProjectionMatrix * vertex;
+}
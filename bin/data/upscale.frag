@@ -0,0 +1,22 @@
+#version 150
+
+// Upscales the reduced-resolution scene to the window. Filtering is
+// bilinear (the source texture is GL_LINEAR); a light unsharp mask
+// restores some of the edge contrast lost at lower render scales.
+// Rectangle texture coordinates are in texels, so neighbors are 1 apart.
+uniform sampler2DRect tex0;
+uniform float sharpness;
+
+in vec2 texCoordVarying;
+out vec4 outputColor;
+
+void main()
+{
+    vec4 center = texture(tex0, texCoordVarying);
+    vec4 neighbors = texture(tex0, texCoordVarying + vec2(1.0, 0.0))
+                   + texture(tex0, texCoordVarying - vec2(1.0, 0.0))
+                   + texture(tex0, texCoordVarying + vec2(0.0, 1.0))
+                   + texture(tex0, texCoordVarying - vec2(0.0, 1.0));
+    vec4 sharpened = center + sharpness * (center - 0.25 * neighbors);
+    outputColor = clamp(sharpened, 0.0, 1.0);
+}
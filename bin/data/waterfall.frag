@@ -0,0 +1,23 @@
+#version 150
+
+// Shows the spectrum history as an image: bands left to right, newest
+// snapshot at the top. Rows are read back from the ring starting at |head|.
+uniform sampler2D history;
+uniform int head;
+
+in vec2 texCoordVarying;
+out vec4 outputColor;
+
+void main()
+{
+    ivec2 size = textureSize(history, 0);
+    int band = min(int(texCoordVarying.x * float(size.x)), size.x - 1);
+    int row = min(int(texCoordVarying.y * float(size.y)), size.y - 1);
+    float magnitude = texelFetch(history, ivec2(band, (head - row + size.y) % size.y), 0).r;
+
+    // Same curve as the heightfield, through black, blue and cyan to white.
+    float level = clamp(sqrt(25.0 * magnitude), 0.0, 1.0);
+    vec3 color = mix(vec3(0.0, 0.0, 0.3), vec3(0.0, 0.8, 1.0), smoothstep(0.0, 0.6, level));
+    color = mix(color, vec3(1.0), smoothstep(0.6, 1.0, level));
+    outputColor = vec4(color * smoothstep(0.0, 0.1, level), 1.0);
+}
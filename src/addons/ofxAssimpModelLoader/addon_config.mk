@@ -60,7 +60,23 @@ common:
 	# a specific platform
 	# ADDON_LIBS_EXCLUDE =
 	
+linux64:
+	# skinning and animation sampling are spread over cores with OpenMP.
+	ADDON_CFLAGS = -fopenmp
+	ADDON_LDFLAGS = -fopenmp
+	
+linux:
+	ADDON_CFLAGS = -fopenmp
+	ADDON_LDFLAGS = -fopenmp
+	
+osx:
+	# Apple's clang has no OpenMP runtime, so it's opt-in there: install
+	# libomp and add -Xpreprocessor -fopenmp and -lomp (with its include
+	# and lib paths). Without it the loops run serially.
+	
 linuxarmv6l:
+	ADDON_CFLAGS = -fopenmp
+	ADDON_LDFLAGS = -fopenmp
 	ADDON_PKG_CONFIG_LIBRARIES = assimp
 	ADDON_LIBS_EXCLUDE = libs/assimp
 	ADDON_INCLUDES_EXCLUDE = libs/assimp/%
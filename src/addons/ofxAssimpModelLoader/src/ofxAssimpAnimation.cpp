@@ -23,6 +23,10 @@ ofxAssimpAnimation::ofxAssimpAnimation(shared_ptr<const aiScene> scene, aiAnimat
     if(animation != NULL) {
         durationInSeconds = animation->mDuration;
         durationInMilliSeconds = durationInSeconds * 1000;
+        
+        tracks = shared_ptr<ofxAssimpAnimationTracks>(new ofxAssimpAnimationTracks(animation, scene ? scene->mRootNode : NULL));
+        cursors.resize(tracks->getNumCursors(), 0);
+        transforms.resize(tracks->getNumTracks());
     }
 }
 
@@ -34,14 +38,35 @@ aiAnimation * ofxAssimpAnimation::getAnimation() {
     return animation;
 }
 
+shared_ptr<ofxAssimpAnimationTracks> ofxAssimpAnimation::getTracks() {
+    return tracks;
+}
+
 void ofxAssimpAnimation::update() {
+    if(advance()) {
+        updateAnimationNodes();
+    }
+}
+
+bool ofxAssimpAnimation::update(ofxAssimpAnimationJob & job) {
+    if(!advance() || !tracks || tracks->getNumTracks() == 0) {
+        return false;
+    }
+    job.tracks = tracks.get();
+    job.time = progressInSeconds;
+    job.cursors = &cursors[0];
+    job.transforms = &transforms[0];
+    return true;
+}
+
+bool ofxAssimpAnimation::advance() {
     animationPrevTime = animationCurrTime;
     animationCurrTime = ofGetElapsedTimef();
     double tps = animation->mTicksPerSecond ? animation->mTicksPerSecond : 25.f;
     animationCurrTime *= tps;
     
     if(!bPlay || bPause) {
-        return;
+        return false;
     }
     
     float duration = getDurationInSeconds();
@@ -60,84 +85,23 @@ void ofxAssimpAnimation::update() {
         // TODO.
     }
     
-    setPosition(position);
+    return setProgress(position);
 }
 
 void ofxAssimpAnimation::updateAnimationNodes() {
-	for(unsigned int i=0; i<animation->mNumChannels; i++) {
-        const aiNodeAnim * channel = animation->mChannels[i];
-        aiNode * targetNode = scene->mRootNode->FindNode(channel->mNodeName);
-        
-        aiVector3D presentPosition(0, 0, 0);
-        if(channel->mNumPositionKeys > 0) {
-            unsigned int frame = 0;
-            while(frame < channel->mNumPositionKeys - 1) {
-                if(progressInSeconds < channel->mPositionKeys[frame+1].mTime) {
-                    break;
-                }
-                frame++;
-            }
-            
-            unsigned int nextFrame = (frame + 1) % channel->mNumPositionKeys;
-            const aiVectorKey & key = channel->mPositionKeys[frame];
-            const aiVectorKey & nextKey = channel->mPositionKeys[nextFrame];
-            double diffTime = nextKey.mTime - key.mTime;
-            if(diffTime < 0.0) {
-                diffTime += getDurationInSeconds();
-            }
-            if(diffTime > 0) {
-                float factor = float((progressInSeconds - key.mTime) / diffTime);
-                presentPosition = key.mValue + (nextKey.mValue - key.mValue) * factor;
-            } else {
-                presentPosition = key.mValue;
-            }
-        }
-        
-        aiQuaternion presentRotation(1, 0, 0, 0);
-        if(channel->mNumRotationKeys > 0) {
-            unsigned int frame = 0;
-            while(frame < channel->mNumRotationKeys - 1) {
-                if(progressInSeconds < channel->mRotationKeys[frame+1].mTime) {
-                    break;
-                }
-                frame++;
-            }
-            
-            unsigned int nextFrame = (frame + 1) % channel->mNumRotationKeys;
-            const aiQuatKey& key = channel->mRotationKeys[frame];
-            const aiQuatKey& nextKey = channel->mRotationKeys[nextFrame];
-            double diffTime = nextKey.mTime - key.mTime;
-            if(diffTime < 0.0) {
-                diffTime += getDurationInSeconds();
-            }
-            if(diffTime > 0) {
-                float factor = float((progressInSeconds - key.mTime) / diffTime);
-                aiQuaternion::Interpolate(presentRotation, key.mValue, nextKey.mValue, factor);
-            } else {
-                presentRotation = key.mValue;
-            }
-        }
-        
-        aiVector3D presentScaling(1, 1, 1);
-        if(channel->mNumScalingKeys > 0) {
-            unsigned int frame = 0;
-            while(frame < channel->mNumScalingKeys - 1){
-                if(progressInSeconds < channel->mScalingKeys[frame+1].mTime) {
-                    break;
-                }
-                frame++;
-            }
-            
-            presentScaling = channel->mScalingKeys[frame].mValue;
+    if(!tracks || tracks->getNumTracks() == 0) {
+        return;
+    }
+    tracks->sample(progressInSeconds, &cursors[0], &transforms[0]);
+    applyTransforms();
+}
+
+void ofxAssimpAnimation::applyTransforms() {
+    for(unsigned int i=0; i<tracks->getNumTracks(); i++) {
+        aiNode * targetNode = tracks->getTargetNode(i);
+        if(targetNode != NULL) {
+            targetNode->mTransformation = transforms[i];
         }
-        
-        aiMatrix4x4 mat = aiMatrix4x4(presentRotation.GetMatrix());
-        mat.a1 *= presentScaling.x; mat.b1 *= presentScaling.x; mat.c1 *= presentScaling.x;
-        mat.a2 *= presentScaling.y; mat.b2 *= presentScaling.y; mat.c2 *= presentScaling.y;
-        mat.a3 *= presentScaling.z; mat.b3 *= presentScaling.z; mat.c3 *= presentScaling.z;
-        mat.a4 = presentPosition.x; mat.b4 = presentPosition.y; mat.c4 = presentPosition.z;
-        
-        targetNode->mTransformation = mat;
     }
 }
 
@@ -212,15 +176,20 @@ void ofxAssimpAnimation::setPaused(bool paused) {
 }
 
 void ofxAssimpAnimation::setPosition(float position) {
+    if(setProgress(position)) {
+        updateAnimationNodes();
+    }
+}
+
+bool ofxAssimpAnimation::setProgress(float position) {
     position = ofClamp(position, 0.0f, 1.0f);
     if(progress == position) {
-        return;
+        return false;
     }
     progress = position;
     progressInSeconds = progress * getDurationInSeconds();
     progressInMilliSeconds = progress * getDurationInMilliSeconds();
-    
-    updateAnimationNodes();
+    return true;
 }
 
 void ofxAssimpAnimation::setLoopState(ofLoopType state) {
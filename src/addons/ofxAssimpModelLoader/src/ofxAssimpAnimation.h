@@ -8,6 +8,7 @@
 #include "ofMain.h"
 #include "assimp.h"
 #include "aiScene.h"
+#include "ofxAssimpAnimationTracks.h"
 
 class ofxAssimpAnimation {
 
@@ -18,7 +19,17 @@ public:
     
     aiAnimation * getAnimation();
     
+    // keyframes, shared between copies of this animation.
+    shared_ptr<ofxAssimpAnimationTracks> getTracks();
+    
     void update();
+
+    // like update(), but leaves sampling to the caller so that several
+    // animations can be sampled together. returns true and fills in |job|
+    // if the position moved; applyTransforms() then poses the nodes once
+    // |job| has been sampled.
+    bool update(ofxAssimpAnimationJob & job);
+    void applyTransforms();
     
     void play();
     void stop();
@@ -43,10 +54,16 @@ public:
     
 protected:
     
+    // moves the playhead without posing the nodes. returns true if it moved.
+    bool advance();
+    bool setProgress(float position);
     void updateAnimationNodes();
     
     shared_ptr<const aiScene> scene;
     aiAnimation * animation;
+    shared_ptr<ofxAssimpAnimationTracks> tracks;
+    vector<unsigned int> cursors;
+    vector<aiMatrix4x4> transforms;
     float animationCurrTime;
     float animationPrevTime;
     bool bPlay;
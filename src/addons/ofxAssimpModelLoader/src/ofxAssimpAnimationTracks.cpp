@@ -0,0 +1,203 @@
+//
+//  ofxAssimpAnimationTracks.cpp
+//
+
+#include "ofxAssimpAnimationTracks.h"
+
+#include <algorithm>
+
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+//--------------------------------------------------------------
+static void appendKey(vector<float> & times, vector<float> & values, double time, float x, float y, float z, float w){
+    times.push_back(time);
+    values.push_back(x);
+    values.push_back(y);
+    values.push_back(z);
+    values.push_back(w);
+}
+
+//--------------------------------------------------------------
+// index of the last key at or before |time|. starts from the cursor and
+// walks forward, which is a step or two while playing; a jump backwards
+// (loop, seek) falls back to a binary search.
+static unsigned int findKey(const float * times, unsigned int numKeys, float time, unsigned int & cursor){
+    unsigned int frame = cursor;
+    if(frame >= numKeys || time < times[frame]){
+        frame = std::upper_bound(times, times + numKeys, time) - times;
+        frame = frame > 0 ? frame - 1 : 0;
+    }
+    while(frame < numKeys - 1 && time >= times[frame + 1]){
+        frame++;
+    }
+    cursor = frame;
+    return frame;
+}
+
+//--------------------------------------------------------------
+// interpolation factor between key |frame| and the next one, wrapping
+// round to the first key after the last.
+static float getFactor(const float * times, unsigned int numKeys, unsigned int frame, float time, float duration, unsigned int & nextFrame){
+    nextFrame = (frame + 1) % numKeys;
+    float diffTime = times[nextFrame] - times[frame];
+    if(diffTime < 0) {
+        diffTime += duration;
+    }
+    return diffTime > 0 ? (time - times[frame]) / diffTime : 0;
+}
+
+//--------------------------------------------------------------
+static void lerp(const float * a, const float * b, float factor, float * out){
+#if defined(__SSE__)
+    __m128 va = _mm_loadu_ps(a);
+    __m128 vb = _mm_loadu_ps(b);
+    _mm_storeu_ps(out, _mm_add_ps(va, _mm_mul_ps(_mm_sub_ps(vb, va), _mm_set1_ps(factor))));
+#else
+    for(int i = 0; i < 4; i++){
+        out[i] = a[i] + (b[i] - a[i]) * factor;
+    }
+#endif
+}
+
+//--------------------------------------------------------------
+// same result as aiQuaternion::Interpolate().
+static void slerp(const float * a, const float * b, float factor, float * out){
+#if defined(__SSE__)
+    __m128 va = _mm_loadu_ps(a);
+    __m128 vb = _mm_loadu_ps(b);
+    __m128 products = _mm_mul_ps(va, vb);
+    products = _mm_add_ps(products, _mm_movehl_ps(products, products));
+    products = _mm_add_ss(products, _mm_shuffle_ps(products, products, _MM_SHUFFLE(1, 1, 1, 1)));
+    float cosom = _mm_cvtss_f32(products);
+#else
+    float cosom = a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3];
+#endif
+
+    // take the short way round.
+    float sign = 1;
+    if(cosom < 0) {
+        cosom = -cosom;
+        sign = -1;
+    }
+
+    float sclp, sclq;
+    if(1 - cosom > 0.0001f) {
+        float omega = acosf(cosom);
+        float sinom = sinf(omega);
+        sclp = sinf((1 - factor) * omega) / sinom;
+        sclq = sinf(factor * omega) / sinom;
+    } else {
+        sclp = 1 - factor;
+        sclq = factor;
+    }
+    sclq *= sign;
+
+#if defined(__SSE__)
+    _mm_storeu_ps(out, _mm_add_ps(_mm_mul_ps(va, _mm_set1_ps(sclp)), _mm_mul_ps(vb, _mm_set1_ps(sclq))));
+#else
+    for(int i = 0; i < 4; i++){
+        out[i] = sclp * a[i] + sclq * b[i];
+    }
+#endif
+}
+
+//--------------------------------------------------------------
+ofxAssimpAnimationTracks::ofxAssimpAnimationTracks(const aiAnimation * animation, aiNode * rootNode){
+    duration = animation->mDuration;
+    tracks.resize(animation->mNumChannels);
+
+    for(unsigned int i = 0; i < animation->mNumChannels; i++){
+        const aiNodeAnim * channel = animation->mChannels[i];
+        Track & track = tracks[i];
+        track.node = rootNode ? rootNode->FindNode(channel->mNodeName) : NULL;
+
+        track.positionOffset = positionTimes.size();
+        track.numPositionKeys = channel->mNumPositionKeys;
+        for(unsigned int k = 0; k < channel->mNumPositionKeys; k++){
+            const aiVectorKey & key = channel->mPositionKeys[k];
+            appendKey(positionTimes, positionValues, key.mTime, key.mValue.x, key.mValue.y, key.mValue.z, 0);
+        }
+
+        track.rotationOffset = rotationTimes.size();
+        track.numRotationKeys = channel->mNumRotationKeys;
+        for(unsigned int k = 0; k < channel->mNumRotationKeys; k++){
+            const aiQuatKey & key = channel->mRotationKeys[k];
+            appendKey(rotationTimes, rotationValues, key.mTime, key.mValue.x, key.mValue.y, key.mValue.z, key.mValue.w);
+        }
+
+        track.scalingOffset = scalingTimes.size();
+        track.numScalingKeys = channel->mNumScalingKeys;
+        for(unsigned int k = 0; k < channel->mNumScalingKeys; k++){
+            const aiVectorKey & key = channel->mScalingKeys[k];
+            appendKey(scalingTimes, scalingValues, key.mTime, key.mValue.x, key.mValue.y, key.mValue.z, 0);
+        }
+    }
+}
+
+//--------------------------------------------------------------
+unsigned int ofxAssimpAnimationTracks::getNumTracks() const {
+    return tracks.size();
+}
+
+unsigned int ofxAssimpAnimationTracks::getNumCursors() const {
+    return tracks.size() * 3;
+}
+
+aiNode * ofxAssimpAnimationTracks::getTargetNode(unsigned int track) const {
+    return tracks[track].node;
+}
+
+//--------------------------------------------------------------
+void ofxAssimpAnimationTracks::sample(float time, unsigned int * cursors, aiMatrix4x4 * transforms) const {
+    for(unsigned int i = 0; i < tracks.size(); i++){
+        const Track & track = tracks[i];
+        unsigned int * cursor = cursors + 3 * i;
+        unsigned int frame, nextFrame;
+
+        float position[4] = { 0, 0, 0, 0 };
+        if(track.numPositionKeys > 0) {
+            const float * times = &positionTimes[track.positionOffset];
+            const float * values = &positionValues[4 * track.positionOffset];
+            frame = findKey(times, track.numPositionKeys, time, cursor[0]);
+            float factor = getFactor(times, track.numPositionKeys, frame, time, duration, nextFrame);
+            lerp(values + 4 * frame, values + 4 * nextFrame, factor, position);
+        }
+
+        float rotation[4] = { 0, 0, 0, 1 };
+        if(track.numRotationKeys > 0) {
+            const float * times = &rotationTimes[track.rotationOffset];
+            const float * values = &rotationValues[4 * track.rotationOffset];
+            frame = findKey(times, track.numRotationKeys, time, cursor[1]);
+            float factor = getFactor(times, track.numRotationKeys, frame, time, duration, nextFrame);
+            slerp(values + 4 * frame, values + 4 * nextFrame, factor, rotation);
+        }
+
+        // scaling steps from key to key.
+        float scaling[4] = { 1, 1, 1, 0 };
+        if(track.numScalingKeys > 0) {
+            const float * times = &scalingTimes[track.scalingOffset];
+            frame = findKey(times, track.numScalingKeys, time, cursor[2]);
+            memcpy(scaling, &scalingValues[4 * (track.scalingOffset + frame)], sizeof(scaling));
+        }
+
+        aiMatrix4x4 & mat = transforms[i];
+        mat = aiMatrix4x4(aiQuaternion(rotation[3], rotation[0], rotation[1], rotation[2]).GetMatrix());
+        mat.a1 *= scaling[0]; mat.b1 *= scaling[0]; mat.c1 *= scaling[0];
+        mat.a2 *= scaling[1]; mat.b2 *= scaling[1]; mat.c2 *= scaling[1];
+        mat.a3 *= scaling[2]; mat.b3 *= scaling[2]; mat.c3 *= scaling[2];
+        mat.a4 = position[0]; mat.b4 = position[1]; mat.c4 = position[2];
+    }
+}
+
+//--------------------------------------------------------------
+void ofxAssimpAnimationTracks::sampleBatch(vector<ofxAssimpAnimationJob> & jobs){
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for(int i = 0; i < (int)jobs.size(); i++){
+        ofxAssimpAnimationJob & job = jobs[i];
+        job.tracks->sample(job.time, job.cursors, job.transforms);
+    }
+}
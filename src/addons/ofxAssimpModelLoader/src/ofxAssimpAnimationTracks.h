@@ -0,0 +1,69 @@
+//
+//  ofxAssimpAnimationTracks.h
+//
+//  Keyframes of an aiAnimation, repacked at load time for fast sampling.
+//  Every channel becomes a track; key times and values of all tracks are
+//  kept in flat arrays (values padded to 4 floats) and target nodes are
+//  resolved once instead of by name every frame.
+//
+//  The tracks are read-only once built, so several instances of an
+//  animation can share them. Each instance keeps its own cursors (the key
+//  it sampled last) so playing forward finds the next key in O(1).
+//
+
+#pragma once
+
+#include "ofMain.h"
+#include "assimp.h"
+#include "aiScene.h"
+
+class ofxAssimpAnimationTracks;
+
+// one instance of an animation to sample in sampleBatch().
+struct ofxAssimpAnimationJob {
+    const ofxAssimpAnimationTracks * tracks;
+    float time;
+    unsigned int * cursors;     // getNumCursors() entries
+    aiMatrix4x4 * transforms;   // getNumTracks() entries
+};
+
+class ofxAssimpAnimationTracks {
+
+public:
+
+    ofxAssimpAnimationTracks(const aiAnimation * animation, aiNode * rootNode);
+
+    unsigned int getNumTracks() const;
+    unsigned int getNumCursors() const;
+
+    // node animated by |track|, NULL if the scene doesn't have it.
+    aiNode * getTargetNode(unsigned int track) const;
+
+    // samples every track at |time| (in ticks) into a local transform per
+    // track. |cursors| carries key positions between calls; zero it for
+    // a new instance.
+    void sample(float time, unsigned int * cursors, aiMatrix4x4 * transforms) const;
+
+    // samples many instances at once, spread over cores with OpenMP. used
+    // by ofxAssimpModelLoader to sample all of a model's playing animations.
+    static void sampleBatch(vector<ofxAssimpAnimationJob> & jobs);
+
+private:
+
+    struct Track {
+        aiNode * node;
+        unsigned int positionOffset, numPositionKeys;
+        unsigned int rotationOffset, numRotationKeys;
+        unsigned int scalingOffset, numScalingKeys;
+    };
+
+    float duration;
+    vector<Track> tracks;
+
+    vector<float> positionTimes;
+    vector<float> positionValues;   // x, y, z, 0
+    vector<float> rotationTimes;
+    vector<float> rotationValues;   // x, y, z, w
+    vector<float> scalingTimes;
+    vector<float> scalingValues;    // x, y, z, 0
+};
@@ -0,0 +1,23 @@
+//
+//  ofxAssimpImportThread.cpp
+//
+
+#include "ofxAssimpImportThread.h"
+#include "ofxAssimpModelLoader.h"
+
+ofxAssimpImportThread::ofxAssimpImportThread(ofxAssimpModelLoader * loader){
+    this->loader = loader;
+}
+
+void ofxAssimpImportThread::threadedFunction(){
+    while(isThreadRunning()){
+        lock();
+        bool bImport = loader->loadState == OFX_ASSIMP_LOAD_IMPORTING;
+        unlock();
+        if(bImport){
+            loader->importPendingModel();
+        }else{
+            sleep(2);
+        }
+    }
+}
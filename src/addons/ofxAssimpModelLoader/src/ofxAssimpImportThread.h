@@ -0,0 +1,28 @@
+//
+//  ofxAssimpImportThread.h
+//
+//  Reads and imports models on a worker thread for
+//  ofxAssimpModelLoader::loadModelAsync(). The thread lives as long as its
+//  loader and imports whenever the load state is set to importing, so the
+//  GL thread never has to wait for it between loads. Nothing here touches
+//  GL.
+//
+
+#pragma once
+
+#include "ofMain.h"
+
+class ofxAssimpModelLoader;
+
+class ofxAssimpImportThread : public ofThread {
+
+public:
+
+    ofxAssimpImportThread(ofxAssimpModelLoader * loader);
+
+protected:
+
+    void threadedFunction();
+
+    ofxAssimpModelLoader * loader;
+};
@@ -0,0 +1,359 @@
+//
+//  ofxAssimpMeshCache.cpp
+//
+
+#include "ofxAssimpMeshCache.h"
+#include "aiMesh.h"
+
+#include <cstdio>
+#include <sys/stat.h>
+
+#ifndef TARGET_WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+static const char cacheMagic[8] = { 'o', 'f', 'x', 'A', 'M', 'C', 0, 0 };
+
+//--------------------------------------------------------------
+static uint64_t fnv1a(const void * bytes, size_t length, uint64_t hash){
+    const unsigned char * p = (const unsigned char *)bytes;
+    for(size_t i = 0; i < length; i++){
+        hash ^= p[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+//--------------------------------------------------------------
+static uint64_t alignOffset(uint64_t offset){
+    return (offset + 15) & ~(uint64_t)15;
+}
+
+//--------------------------------------------------------------
+static void copyString(char * dst, size_t dstSize, const string & src){
+    memset(dst, 0, dstSize);
+    strncpy(dst, src.c_str(), dstSize - 1);
+}
+
+//--------------------------------------------------------------
+static void copyColor(float * dst, const ofFloatColor & c){
+    dst[0] = c.r;
+    dst[1] = c.g;
+    dst[2] = c.b;
+    dst[3] = c.a;
+}
+
+//--------------------------------------------------------------
+ofxAssimpMeshCache::ofxAssimpMeshCache(){
+    data = NULL;
+    size = 0;
+#ifndef TARGET_WIN32
+    fd = -1;
+#endif
+}
+
+ofxAssimpMeshCache::~ofxAssimpMeshCache(){
+    close();
+}
+
+//--------------------------------------------------------------
+ofxAssimpMeshCacheSource ofxAssimpMeshCache::getSource(string path){
+    ofxAssimpMeshCacheSource source;
+    memset(&source, 0, sizeof(source));
+    struct stat info;
+    if(stat(path.c_str(), &info) == 0){
+        source.size = info.st_size;
+        source.modifiedTime = info.st_mtime;
+    }
+    return source;
+}
+
+//--------------------------------------------------------------
+uint64_t ofxAssimpMeshCache::hashSource(ofBuffer & buffer, unsigned int importFlags, string extension){
+    uint64_t hash = 14695981039346656037ULL;
+    hash = fnv1a(buffer.getBinaryBuffer(), buffer.size(), hash);
+    uint32_t flags = importFlags;
+    hash = fnv1a(&flags, sizeof(flags), hash);
+    hash = fnv1a(extension.c_str(), extension.size(), hash);
+    return hash;
+}
+
+//--------------------------------------------------------------
+string ofxAssimpMeshCache::getCachePath(string modelPath){
+    return modelPath + ".meshcache";
+}
+
+//--------------------------------------------------------------
+bool ofxAssimpMeshCache::write(string path, const ofxAssimpMeshCacheSource & source, unsigned int importFlags,
+                               ofPoint sceneMin, ofPoint sceneMax, vector<ofxAssimpMeshHelper> & meshes){
+    ofxAssimpMeshCacheHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, cacheMagic, sizeof(cacheMagic));
+    header.version = OFX_ASSIMP_MESH_CACHE_VERSION;
+    header.importFlags = importFlags;
+    header.sourceHash = source.hash;
+    header.sourceSize = source.size;
+    header.sourceModifiedTime = source.modifiedTime;
+    header.indexSize = sizeof(ofIndexType);
+    header.numMeshes = meshes.size();
+    for(int i = 0; i < 3; i++){
+        header.sceneMin[i] = sceneMin[i];
+        header.sceneMax[i] = sceneMax[i];
+    }
+
+    // lay out the streams after the mesh table.
+    vector<ofxAssimpMeshCacheEntry> entries(meshes.size());
+    uint64_t offset = alignOffset(sizeof(header) + entries.size() * sizeof(ofxAssimpMeshCacheEntry));
+    for(unsigned int i = 0; i < meshes.size(); i++){
+        ofxAssimpMeshHelper & helper = meshes[i];
+        const aiMesh * mesh = helper.mesh;
+        ofxAssimpMeshCacheEntry & entry = entries[i];
+        memset(&entry, 0, sizeof(entry));
+
+        copyString(entry.name, sizeof(entry.name), helper.name);
+        if(helper.hasTexture()){
+            copyString(entry.texturePath, sizeof(entry.texturePath), helper.assimpTexture.getTexturePath());
+        }
+        entry.numVertices = mesh->mNumVertices;
+        entry.numIndices = helper.indices.size();
+        entry.hasNormals = mesh->HasNormals();
+        entry.hasColors = mesh->HasVertexColors(0);
+        entry.hasTexCoords = helper.cachedMesh.hasTexCoords();
+        entry.twoSided = helper.twoSided;
+        entry.blendMode = helper.blendMode;
+        entry.shininess = helper.material.getShininess();
+        copyColor(entry.diffuse, helper.material.getDiffuseColor());
+        copyColor(entry.specular, helper.material.getSpecularColor());
+        copyColor(entry.ambient, helper.material.getAmbientColor());
+        copyColor(entry.emissive, helper.material.getEmissiveColor());
+        memcpy(entry.matrix, helper.matrix.getPtr(), sizeof(entry.matrix));
+
+        entry.verticesOffset = offset;
+        offset = alignOffset(offset + entry.numVertices * 3 * sizeof(float));
+        if(entry.hasNormals){
+            entry.normalsOffset = offset;
+            offset = alignOffset(offset + entry.numVertices * 3 * sizeof(float));
+        }
+        if(entry.hasColors){
+            entry.colorsOffset = offset;
+            offset = alignOffset(offset + entry.numVertices * 4 * sizeof(float));
+        }
+        if(entry.hasTexCoords){
+            entry.texCoordsOffset = offset;
+            offset = alignOffset(offset + entry.numVertices * 2 * sizeof(float));
+        }
+        entry.indicesOffset = offset;
+        offset = alignOffset(offset + entry.numIndices * sizeof(ofIndexType));
+    }
+
+    string tmpPath = path + ".tmp";
+    FILE * out = fopen(tmpPath.c_str(), "wb");
+    if(!out){
+        ofLogWarning("ofxAssimpMeshCache") << "write(): couldn't create \"" << tmpPath << "\"";
+        return false;
+    }
+
+    // streams are written in layout order; pad up to each offset.
+    bool ok = fwrite(&header, sizeof(header), 1, out) == 1;
+    if(!entries.empty()){
+        ok = ok && fwrite(&entries[0], sizeof(ofxAssimpMeshCacheEntry), entries.size(), out) == entries.size();
+    }
+    uint64_t written = sizeof(header) + entries.size() * sizeof(ofxAssimpMeshCacheEntry);
+    static const char padding[16] = { 0 };
+    for(unsigned int i = 0; i < meshes.size() && ok; i++){
+        const aiMesh * mesh = meshes[i].mesh;
+        const ofxAssimpMeshCacheEntry & entry = entries[i];
+
+        const void * streams[5] = {
+            &mesh->mVertices[0].x,
+            entry.hasNormals ? &mesh->mNormals[0].x : NULL,
+            entry.hasColors ? &mesh->mColors[0][0].r : NULL,
+            entry.hasTexCoords ? meshes[i].cachedMesh.getTexCoordsPointer() : NULL,
+            meshes[i].indices.empty() ? NULL : &meshes[i].indices[0]
+        };
+        uint64_t offsets[5] = { entry.verticesOffset, entry.normalsOffset, entry.colorsOffset,
+                                entry.texCoordsOffset, entry.indicesOffset };
+        size_t sizes[5] = {
+            entry.numVertices * 3 * sizeof(float),
+            entry.numVertices * 3 * sizeof(float),
+            entry.numVertices * 4 * sizeof(float),
+            entry.numVertices * 2 * sizeof(float),
+            entry.numIndices * sizeof(ofIndexType)
+        };
+        for(int s = 0; s < 5 && ok; s++){
+            if(!streams[s]){
+                continue;
+            }
+            ok = ok && fwrite(padding, 1, offsets[s] - written, out) == offsets[s] - written;
+            ok = ok && fwrite(streams[s], 1, sizes[s], out) == sizes[s];
+            written = offsets[s] + sizes[s];
+        }
+    }
+    ok = (fclose(out) == 0) && ok;
+
+    if(!ok || rename(tmpPath.c_str(), path.c_str()) != 0){
+        ofLogWarning("ofxAssimpMeshCache") << "write(): couldn't write \"" << path << "\"";
+        remove(tmpPath.c_str());
+        return false;
+    }
+    ofLogVerbose("ofxAssimpMeshCache") << "write(): wrote " << written << " bytes to \"" << path << "\"";
+    return true;
+}
+
+//--------------------------------------------------------------
+bool ofxAssimpMeshCache::restamp(string path, const ofxAssimpMeshCacheSource & source, unsigned int importFlags){
+    FILE * file = fopen(path.c_str(), "r+b");
+    if(!file){
+        return false;
+    }
+    ofxAssimpMeshCacheHeader header;
+    bool ok = fread(&header, sizeof(header), 1, file) == 1 &&
+              memcmp(header.magic, cacheMagic, sizeof(cacheMagic)) == 0 &&
+              header.version == OFX_ASSIMP_MESH_CACHE_VERSION &&
+              header.sourceHash == source.hash && header.importFlags == importFlags;
+    if(ok){
+        header.sourceSize = source.size;
+        header.sourceModifiedTime = source.modifiedTime;
+        ok = fseek(file, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, file) == 1;
+    }
+    ok = (fclose(file) == 0) && ok;
+    if(ok){
+        ofLogVerbose("ofxAssimpMeshCache") << "restamp(): source of \"" << path << "\" is unchanged";
+    }
+    return ok;
+}
+
+//--------------------------------------------------------------
+bool ofxAssimpMeshCache::open(string path, const ofxAssimpMeshCacheSource & source, unsigned int importFlags){
+    close();
+
+#ifdef TARGET_WIN32
+    if(!ofFile::doesFileExist(path, false)){
+        return false;
+    }
+    buffer = ofBufferFromFile(path, true);
+    data = buffer.getBinaryBuffer();
+    size = buffer.size();
+#else
+    fd = ::open(path.c_str(), O_RDONLY);
+    if(fd < 0){
+        return false;
+    }
+    struct stat info;
+    if(fstat(fd, &info) != 0 || info.st_size == 0){
+        close();
+        return false;
+    }
+    void * mapped = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if(mapped == MAP_FAILED){
+        close();
+        return false;
+    }
+    data = (const char *)mapped;
+    size = info.st_size;
+#endif
+
+    if(!validate(source, importFlags)){
+        close();
+        return false;
+    }
+    return true;
+}
+
+//--------------------------------------------------------------
+bool ofxAssimpMeshCache::validate(const ofxAssimpMeshCacheSource & source, unsigned int importFlags){
+    if(size < sizeof(ofxAssimpMeshCacheHeader)){
+        return false;
+    }
+    const ofxAssimpMeshCacheHeader & header = getHeader();
+    if(memcmp(header.magic, cacheMagic, sizeof(cacheMagic)) != 0 ||
+       header.version != OFX_ASSIMP_MESH_CACHE_VERSION ||
+       header.indexSize != sizeof(ofIndexType)){
+        ofLogVerbose("ofxAssimpMeshCache") << "validate(): cache is from another format version";
+        return false;
+    }
+    if(header.sourceSize != source.size || header.sourceModifiedTime != source.modifiedTime ||
+       header.importFlags != importFlags){
+        ofLogVerbose("ofxAssimpMeshCache") << "validate(): cache is stale";
+        return false;
+    }
+    if(!contains(sizeof(header), (uint64_t)header.numMeshes * sizeof(ofxAssimpMeshCacheEntry))){
+        return false;
+    }
+
+    // make sure every stream lies inside the file.
+    for(unsigned int i = 0; i < header.numMeshes; i++){
+        const ofxAssimpMeshCacheEntry & entry = getEntry(i);
+        uint64_t vertexBytes = (uint64_t)entry.numVertices * sizeof(float);
+        if(!contains(entry.verticesOffset, 3 * vertexBytes) ||
+           (entry.hasNormals && !contains(entry.normalsOffset, 3 * vertexBytes)) ||
+           (entry.hasColors && !contains(entry.colorsOffset, 4 * vertexBytes)) ||
+           (entry.hasTexCoords && !contains(entry.texCoordsOffset, 2 * vertexBytes)) ||
+           !contains(entry.indicesOffset, (uint64_t)entry.numIndices * sizeof(ofIndexType)) ||
+           entry.indicesOffset % sizeof(ofIndexType) != 0){
+            ofLogWarning("ofxAssimpMeshCache") << "validate(): cache is truncated";
+            return false;
+        }
+
+        // indices go straight to the GPU and to skinMesh(), so a bad one
+        // would read past the vertex streams.
+        const ofIndexType * indices = (const ofIndexType *)getData(entry.indicesOffset);
+        for(uint32_t j = 0; j < entry.numIndices; j++){
+            if(indices[j] >= entry.numVertices){
+                ofLogWarning("ofxAssimpMeshCache") << "validate(): mesh " << i << " has an index out of range";
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+//--------------------------------------------------------------
+bool ofxAssimpMeshCache::contains(uint64_t offset, uint64_t bytes){
+    return offset <= size && bytes <= size - offset;
+}
+
+//--------------------------------------------------------------
+void ofxAssimpMeshCache::close(){
+#ifdef TARGET_WIN32
+    buffer.clear();
+#else
+    if(data){
+        munmap((void *)data, size);
+    }
+    if(fd >= 0){
+        ::close(fd);
+        fd = -1;
+    }
+#endif
+    data = NULL;
+    size = 0;
+}
+
+//--------------------------------------------------------------
+bool ofxAssimpMeshCache::isOpen(){
+    return data != NULL;
+}
+
+//--------------------------------------------------------------
+const ofxAssimpMeshCacheHeader & ofxAssimpMeshCache::getHeader(){
+    return *(const ofxAssimpMeshCacheHeader *)data;
+}
+
+//--------------------------------------------------------------
+unsigned int ofxAssimpMeshCache::getNumMeshes(){
+    return getHeader().numMeshes;
+}
+
+//--------------------------------------------------------------
+const ofxAssimpMeshCacheEntry & ofxAssimpMeshCache::getEntry(int meshIndex){
+    const ofxAssimpMeshCacheEntry * entries = (const ofxAssimpMeshCacheEntry *)(data + sizeof(ofxAssimpMeshCacheHeader));
+    return entries[meshIndex];
+}
+
+//--------------------------------------------------------------
+const void * ofxAssimpMeshCache::getData(uint64_t offset){
+    return data + offset;
+}
@@ -0,0 +1,131 @@
+//
+//  ofxAssimpMeshCache.h
+//
+//  Binary cache of post-processed, GPU-ready mesh data, so static models
+//  can be loaded without running Assimp. A cache file is only used if it
+//  was written for the same source file and import flags. Warm starts only
+//  compare the source's size and modification time; the source bytes are
+//  hashed only when those change.
+//
+//  Layout (native byte order, every stream 16 byte aligned):
+//      ofxAssimpMeshCacheHeader
+//      ofxAssimpMeshCacheEntry[numMeshes]
+//      per mesh: vertices (3 floats), normals (3 floats), colors (4 floats),
+//                tex coords (2 floats), indices (ofIndexType)
+//
+
+#pragma once
+
+#include "ofMain.h"
+#include "ofxAssimpMeshHelper.h"
+
+#include <stdint.h>
+
+// bump whenever the layout below changes.
+#define OFX_ASSIMP_MESH_CACHE_VERSION 2
+
+// identifies the source file a cache was written for. |hash| covers the
+// source bytes, import flags and extension, and is 0 until computed.
+struct ofxAssimpMeshCacheSource {
+    uint64_t size;
+    int64_t modifiedTime;
+    uint64_t hash;
+};
+
+struct ofxAssimpMeshCacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t importFlags;
+    uint64_t sourceHash;
+    uint64_t sourceSize;
+    int64_t sourceModifiedTime;
+    uint32_t indexSize;
+    uint32_t numMeshes;
+    float sceneMin[3];
+    float sceneMax[3];
+};
+
+struct ofxAssimpMeshCacheEntry {
+    char name[64];
+    char texturePath[512];
+
+    uint32_t numVertices;
+    uint32_t numIndices;
+    uint32_t hasNormals;
+    uint32_t hasColors;
+    uint32_t hasTexCoords;
+    uint32_t twoSided;
+    int32_t blendMode;
+    float shininess;
+
+    float diffuse[4];
+    float specular[4];
+    float ambient[4];
+    float emissive[4];
+    float matrix[16];
+
+    uint64_t verticesOffset;
+    uint64_t normalsOffset;
+    uint64_t colorsOffset;
+    uint64_t texCoordsOffset;
+    uint64_t indicesOffset;
+};
+
+class ofxAssimpMeshCache {
+
+public:
+
+    ofxAssimpMeshCache();
+    ~ofxAssimpMeshCache();
+
+    // size and modification time of the model at |path|, without reading it.
+    static ofxAssimpMeshCacheSource getSource(string path);
+
+    // hash of a model's source bytes, import flags and extension.
+    static uint64_t hashSource(ofBuffer & buffer, unsigned int importFlags, string extension);
+
+    // where the cache for a model file lives, next to the model.
+    static string getCachePath(string modelPath);
+
+    // writes |meshes| (already loaded from Assimp and positioned by update())
+    // to |path|. the file is written under a temporary name and renamed,
+    // so readers never see a partial cache.
+    static bool write(string path, const ofxAssimpMeshCacheSource & source, unsigned int importFlags,
+                      ofPoint sceneMin, ofPoint sceneMax, vector<ofxAssimpMeshHelper> & meshes);
+
+    // for a source whose size or modification time changed but whose bytes
+    // didn't (e.g. a fresh checkout), records the new ones in the cache at
+    // |path| so later opens match again. |source.hash| must be filled in.
+    // fails if the cache was written for different bytes or flags.
+    static bool restamp(string path, const ofxAssimpMeshCacheSource & source, unsigned int importFlags);
+
+    // maps |path| into memory. fails if it doesn't exist, is damaged, or
+    // was written for a different source size or modification time, flags
+    // or format version.
+    bool open(string path, const ofxAssimpMeshCacheSource & source, unsigned int importFlags);
+    void close();
+    bool isOpen();
+
+    const ofxAssimpMeshCacheHeader & getHeader();
+    unsigned int getNumMeshes();
+    const ofxAssimpMeshCacheEntry & getEntry(int meshIndex);
+
+    // pointer to a stream at |offset| in the mapped file.
+    const void * getData(uint64_t offset);
+
+private:
+
+    bool validate(const ofxAssimpMeshCacheSource & source, unsigned int importFlags);
+
+    // whether |bytes| at |offset| lie inside the mapped file.
+    bool contains(uint64_t offset, uint64_t bytes);
+
+    const char * data;
+    size_t size;
+
+#ifdef TARGET_WIN32
+    ofBuffer buffer;
+#else
+    int fd;
+#endif
+};
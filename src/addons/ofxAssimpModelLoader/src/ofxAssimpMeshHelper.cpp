@@ -13,6 +13,7 @@ ofxAssimpMeshHelper::ofxAssimpMeshHelper() {
     twoSided = false;
     hasChanged = false;
     validCache = false;
+    validSkin = false;
 }
 
 bool ofxAssimpMeshHelper::hasTexture() {
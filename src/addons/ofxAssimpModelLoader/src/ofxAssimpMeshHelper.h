@@ -20,7 +20,8 @@ public:
     bool hasTexture();
     ofTexture & getTextureRef();
     
-    aiMesh * mesh; // pointer to the aiMesh we represent.
+    aiMesh * mesh; // pointer to the aiMesh we represent, NULL if loaded from a mesh cache.
+    string name;
 
     ofVbo vbo;
     
@@ -37,6 +38,16 @@ public:
     vector<aiVector3D> animatedPos;
     vector<aiVector3D> animatedNorm;
 
+    // skinning tables, built once per model. bone b of the mesh is driven by
+    // skeleton node boneNodes[b]. each vertex has 4 influences stored next to
+    // each other in boneIndices / boneWeights, heaviest first, zero-weighted
+    // when unused. boneMatrices is scratch space for the current pose.
+    vector<int> boneNodes;
+    vector<unsigned int> boneIndices;
+    vector<float> boneWeights;
+    vector<aiMatrix4x4> boneMatrices;
+    bool validSkin; // animatedPos / animatedNorm match boneMatrices.
+
     ofMesh cachedMesh;
     bool validCache;
     
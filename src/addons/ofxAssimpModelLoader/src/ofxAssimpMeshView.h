@@ -0,0 +1,49 @@
+//
+//  ofxAssimpMeshView.h
+//
+//  Non-owning views over a loaded model's vertex data, so meshes can be
+//  read every frame without copying them into an ofMesh.
+//
+
+#pragma once
+
+#include "ofMain.h"
+#include "aiVector3D.h"
+
+// views over Assimp's vertex arrays reinterpret aiVector3D as ofVec3f.
+static_assert(sizeof(aiVector3D) == sizeof(ofVec3f), "aiVector3D and ofVec3f must share a layout");
+
+template<typename T>
+class ofxAssimpSpan {
+
+public:
+
+    ofxAssimpSpan() : ptr(NULL), count(0) {}
+    ofxAssimpSpan(const T * ptr, size_t count) : ptr(count ? ptr : NULL), count(count) {}
+
+    const T * data() const { return ptr; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    const T & operator[](size_t i) const { return ptr[i]; }
+    const T * begin() const { return ptr; }
+    const T * end() const { return ptr + count; }
+
+private:
+
+    const T * ptr;
+    size_t count;
+};
+
+// triangles: every 3 indices form one face. normals is empty if the mesh
+// has none.
+struct ofxAssimpMeshView {
+    ofxAssimpSpan<ofVec3f> vertices;
+    ofxAssimpSpan<ofVec3f> normals;
+    ofxAssimpSpan<ofIndexType> indices;
+
+    size_t getNumTriangles() const { return indices.size() / 3; }
+    const ofVec3f & getTriangleVertex(size_t triangle, int corner) const {
+        return vertices[indices[3 * triangle + corner]];
+    }
+};
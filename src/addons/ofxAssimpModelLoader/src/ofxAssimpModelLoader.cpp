@@ -6,11 +6,40 @@
 #include "aiConfig.h"
 #include "aiPostProcess.h"
 
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+// largest upload in one step of an async load, in bytes. a step is a band
+// of texture rows or a range of one buffer.
+static const size_t uploadSliceSize = 256 * 1024;
+
+//-------------------------------------------
+static void reserveBuffer(GLenum target, GLuint id, size_t size, int usage){
+    glBindBuffer(target, id);
+    glBufferData(target, size, NULL, usage);
+    glBindBuffer(target, 0);
+}
+
 ofxAssimpModelLoader::ofxAssimpModelLoader(){
+    bUsingMeshCache = false;
+    bUsingGPUSkinning = false;
+    loadState = OFX_ASSIMP_LOAD_IDLE;
+    pendingFlags = 0;
+    bQueuedLoad = false;
+    queuedFlags = 0;
+    pendingImageIndex = 0;
+    pendingMeshIndex = 0;
+    pendingBufferIndex = 0;
+    pendingOffset = 0;
+    uploadBudget = 4;
 	clear();
 }
 
 ofxAssimpModelLoader::~ofxAssimpModelLoader(){
+    if(importThread){
+        importThread->waitForThread(true);
+    }
     clear();
 }
 
@@ -25,13 +54,433 @@ bool ofxAssimpModelLoader::loadModel(string modelName, bool optimize){
     ofLogVerbose("ofxAssimpModelLoader") << "loadModel(): loading \"" << file.getFileName()
 		<< "\" from \"" << file.getEnclosingDirectory() << "\"";
     
+    if(!bUsingMeshCache){
+        ofBuffer buffer = file.readToBuffer();
+        return loadModel(buffer, optimize, file.getExtension().c_str());
+    }
+
+    // try the cache first. it's keyed by the source's size, modification
+    // time and import flags, so a warm start doesn't read the model at all.
+    unsigned int flags = getImportFlags(optimize);
+    ofxAssimpMeshCacheSource source = ofxAssimpMeshCache::getSource(file.getAbsolutePath());
+    string cachePath = ofxAssimpMeshCache::getCachePath(file.getAbsolutePath());
+    if(source.size > 0 && loadModelFromCache(cachePath, source, flags)){
+        return true;
+    }
+
+    // the model was touched or edited. if its bytes still hash the same,
+    // keep the cache and record the new stamp; otherwise rebuild it.
     ofBuffer buffer = file.readToBuffer();
-    
+    source.hash = ofxAssimpMeshCache::hashSource(buffer, flags, file.getExtension());
+    if(ofxAssimpMeshCache::restamp(cachePath, source, flags) && loadModelFromCache(cachePath, source, flags)){
+        return true;
+    }
+
     bool bOk = loadModel(buffer, optimize, file.getExtension().c_str());
 
+    // animated models need the Assimp scene at runtime, so only static ones are cached.
+    if(bOk && !hasAnimations()){
+        ofxAssimpMeshCache::write(cachePath, source, flags, getSceneMin(), getSceneMax(), modelMeshes);
+    }
+
     return bOk;
 }
 
+//-------------------------------------------
+bool ofxAssimpModelLoader::loadModelAsync(string modelName, bool optimize){
+    ofFile modelFile(modelName, ofFile::ReadOnly, true);
+    if(!modelFile.exists()) {
+        ofLogVerbose("ofxAssimpModelLoader") << "loadModelAsync(): model does not exist: \"" << modelName << "\"";
+        return false;
+    }
+
+    // one import at a time. the newest request waits here, replacing any
+    // older one still waiting, and update() starts it once the import
+    // thread is free.
+    queuedFile = modelFile;
+    queuedFlags = getImportFlags(optimize);
+    bQueuedLoad = true;
+    startQueuedLoad();
+    return true;
+}
+
+//-------------------------------------------
+void ofxAssimpModelLoader::startQueuedLoad(){
+    if(!bQueuedLoad || (importThread && getImportState() == OFX_ASSIMP_LOAD_IMPORTING)){
+        return;
+    }
+
+    // the import thread is idle. whatever it finished last, or whatever is
+    // half uploaded, belongs to an older request.
+    bQueuedLoad = false;
+    pendingScene.reset();
+    pendingMeshes.clear();
+    pendingMeshTextures.clear();
+    pendingImages.clear();
+    pendingTextures.clear();
+    pendingImageIndex = 0;
+    pendingMeshIndex = 0;
+    pendingBuffers.clear();
+    pendingBufferIndex = 0;
+    pendingOffset = 0;
+    pendingFile = queuedFile;
+    pendingFlags = queuedFlags;
+
+    // import properties are global to Assimp, so set them here rather than on the thread.
+	aiSetImportPropertyInteger(AI_CONFIG_PP_SBP_REMOVE, aiPrimitiveType_LINE | aiPrimitiveType_POINT );
+	aiSetImportPropertyInteger(AI_CONFIG_PP_PTV_NORMALIZE, true);
+
+    // the thread stays up between loads and picks the request up as soon
+    // as the state says so.
+    if(!importThread){
+        importThread = shared_ptr<ofxAssimpImportThread>(new ofxAssimpImportThread(this));
+        importThread->startThread(true, false);
+    }
+    setLoadState(OFX_ASSIMP_LOAD_IMPORTING);
+}
+
+//-------------------------------------------
+void ofxAssimpModelLoader::importPendingModel(){
+    ofLogVerbose("ofxAssimpModelLoader") << "importPendingModel(): importing \"" << pendingFile.getFileName() << "\"";
+
+    ofBuffer buffer = pendingFile.readToBuffer();
+    shared_ptr<const aiScene> imported(aiImportFileFromMemory(buffer.getBinaryBuffer(), buffer.size(), pendingFlags,
+                                                              pendingFile.getExtension().c_str()), aiReleaseImport);
+    if(!imported){
+        ofLogError("ofxAssimpModelLoader") << "importPendingModel(): " + (string) aiGetErrorString();
+        setLoadState(OFX_ASSIMP_LOAD_FAILED);
+        return;
+    }
+
+    aiVector3D min, max;
+    getBoundingBoxWithMinVector(imported.get(), &min, &max);
+
+    // convert the meshes and decode their textures here, so that only GL
+    // uploads are left for update().
+    string modelFolder = pendingFile.getEnclosingDirectory();
+    vector<ofxAssimpMeshHelper> meshes(imported->mNumMeshes, ofxAssimpMeshHelper());
+    vector<string> meshTextures(imported->mNumMeshes);
+    vector<ofxAssimpPendingImage> images;
+    for(unsigned int i = 0; i < imported->mNumMeshes; i++){
+        loadMeshData(imported.get(), i, meshes[i]);
+        meshTextures[i] = getMeshTexturePath(imported.get(), i, modelFolder);
+        if(meshTextures[i].empty()){
+            continue;
+        }
+        bool bDecoded = false;
+        for(size_t j = 0; j < images.size() && !bDecoded; j++){
+            bDecoded = images[j].path == meshTextures[i];
+        }
+        if(!bDecoded){
+            // failed images stay in the list unallocated, so they're only tried once.
+            images.push_back(ofxAssimpPendingImage());
+            images.back().path = meshTextures[i];
+            if(!ofLoadImage(images.back().pixels, meshTextures[i])){
+                ofLogError("ofxAssimpModelLoader") << "importPendingModel(): couldn't load texture: \""
+                    << pendingFile.getFileName() << "\" from \"" << meshTextures[i] << "\"";
+            }
+        }
+    }
+
+    importThread->lock();
+    pendingScene = imported;
+    pendingMin = min;
+    pendingMax = max;
+    pendingMeshes.swap(meshes);
+    pendingMeshTextures.swap(meshTextures);
+    pendingImages.swap(images);
+    loadState = OFX_ASSIMP_LOAD_UPLOADING;
+    importThread->unlock();
+}
+
+//-------------------------------------------
+void ofxAssimpModelLoader::uploadPendingModel(){
+    if(getLoadState() != OFX_ASSIMP_LOAD_UPLOADING){
+        return;
+    }
+    // upload slices until this frame's budget is spent.
+    unsigned long long start = ofGetElapsedTimeMicros();
+    while(uploadPendingSlice()){
+        if(ofGetElapsedTimeMicros() - start > uploadBudget * 1000){
+            return;
+        }
+    }
+
+    // everything is on the GPU, swap the new model in.
+    ofLogVerbose("ofxAssimpModelLoader") << "uploadPendingModel(): \"" << pendingFile.getFileName() << "\" is ready";
+    normalizeFactor = ofGetWidth() / 2.0;
+    clear();
+    scene = pendingScene;
+    file = pendingFile;
+    modelMeshes.swap(pendingMeshes);
+    textures.swap(pendingTextures);
+    pendingScene.reset();
+    pendingMeshes.clear();
+    pendingMeshTextures.clear();
+    pendingImages.clear();
+    pendingTextures.clear();
+
+    for(unsigned int i=0; i<scene->mNumAnimations; i++) {
+        animations.push_back(ofxAssimpAnimation(scene, scene->mAnimations[i]));
+    }
+    buildSkeleton();
+
+    scene_min = pendingMin;
+    scene_max = pendingMax;
+    calculateScale();
+
+    ofAddListener(ofEvents().exit,this,&ofxAssimpModelLoader::onAppExit);
+    setLoadState(OFX_ASSIMP_LOAD_DONE);
+}
+
+//-------------------------------------------
+bool ofxAssimpModelLoader::uploadPendingSlice(){
+    // textures first, so that meshes can pick theirs up when they start.
+    if(pendingImageIndex < pendingImages.size()){
+        ofxAssimpPendingImage & image = pendingImages[pendingImageIndex];
+        ofPixels & pixels = image.pixels;
+        if(pixels.isAllocated()){
+            if(pendingOffset == 0){
+                image.texture.allocate(pixels.getWidth(), pixels.getHeight(), ofGetGlInternalFormat(pixels));
+            }
+            size_t rowSize = pixels.getWidth() * pixels.getNumChannels();
+            size_t rows = MIN(MAX(uploadSliceSize / rowSize, (size_t)1), pixels.getHeight() - pendingOffset);
+            ofTextureData & data = image.texture.getTextureData();
+            GLint alignment;
+            glGetIntegerv(GL_UNPACK_ALIGNMENT, &alignment);
+            glBindTexture(data.textureTarget, data.textureID);
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            glTexSubImage2D(data.textureTarget, 0, 0, pendingOffset, pixels.getWidth(), rows,
+                            ofGetGlFormat(pixels), GL_UNSIGNED_BYTE, pixels.getPixels() + pendingOffset * rowSize);
+            glBindTexture(data.textureTarget, 0);
+            glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
+            pendingOffset += rows;
+            if(pendingOffset < (size_t)pixels.getHeight()){
+                return true;
+            }
+            pendingTextures.push_back(ofxAssimpTexture(image.texture, image.path));
+            pixels.clear();
+        }
+        pendingImageIndex++;
+        pendingOffset = 0;
+        return true;
+    }
+
+    if(pendingMeshIndex < pendingMeshes.size()){
+        ofxAssimpMeshHelper & meshHelper = pendingMeshes[pendingMeshIndex];
+        if(pendingBuffers.empty()){
+            for(size_t i = 0; i < pendingTextures.size(); i++){
+                if(pendingTextures[i].getTexturePath() == pendingMeshTextures[pendingMeshIndex]){
+                    meshHelper.assimpTexture = pendingTextures[i];
+                }
+            }
+            beginMeshUpload(meshHelper);
+            pendingBufferIndex = 0;
+            pendingOffset = 0;
+            return true;
+        }
+        ofxAssimpUploadBuffer & buffer = pendingBuffers[pendingBufferIndex];
+        size_t size = MIN(uploadSliceSize, buffer.size - pendingOffset);
+        if(buffer.bTexCoords){
+            // the import thread left them in 0-1, the texture exists now.
+            vector<ofVec2f> & texCoords = meshHelper.cachedMesh.getTexCoords();
+            ofTexture & texture = meshHelper.getTextureRef();
+            for(size_t i = pendingOffset / sizeof(ofVec2f); i < (pendingOffset + size) / sizeof(ofVec2f); i++){
+                texCoords[i] = texture.getCoordFromPercent(texCoords[i].x, texCoords[i].y);
+            }
+        }
+        glBindBuffer(buffer.target, buffer.id);
+        glBufferSubData(buffer.target, pendingOffset, size, buffer.data + pendingOffset);
+        glBindBuffer(buffer.target, 0);
+        pendingOffset += size;
+        if(pendingOffset == buffer.size){
+            pendingBufferIndex++;
+            pendingOffset = 0;
+        }
+        if(pendingBufferIndex == pendingBuffers.size()){
+            pendingBuffers.clear();
+            pendingMeshIndex++;
+        }
+        return true;
+    }
+
+    return false;
+}
+
+//-------------------------------------------
+void ofxAssimpModelLoader::beginMeshUpload(ofxAssimpMeshHelper & meshHelper){
+    // ofVbo only creates a buffer along with its data, so each one is created
+    // with a single element and then resized to hold the whole array.
+    aiMesh * mesh = meshHelper.mesh;
+    int numVertices = mesh->mNumVertices;
+    int usage = getMeshUsage(pendingScene.get());
+    ofxAssimpUploadBuffer buffer;
+    buffer.target = GL_ARRAY_BUFFER;
+    buffer.bTexCoords = false;
+
+    meshHelper.vbo.setVertexData(&mesh->mVertices[0].x, 3, 1, usage, sizeof(aiVector3D));
+    buffer.id = meshHelper.vbo.getVertId();
+    buffer.data = (const char *)mesh->mVertices;
+    buffer.size = numVertices * sizeof(aiVector3D);
+    reserveBuffer(buffer.target, buffer.id, buffer.size, usage);
+    pendingBuffers.push_back(buffer);
+
+    if(mesh->HasVertexColors(0)){
+        meshHelper.vbo.setColorData(&mesh->mColors[0][0].r, 1, GL_STATIC_DRAW, sizeof(aiColor4D));
+        buffer.id = meshHelper.vbo.getColorId();
+        buffer.data = (const char *)mesh->mColors[0];
+        buffer.size = numVertices * sizeof(aiColor4D);
+        reserveBuffer(buffer.target, buffer.id, buffer.size, GL_STATIC_DRAW);
+        pendingBuffers.push_back(buffer);
+    }
+    if(mesh->HasNormals()){
+        meshHelper.vbo.setNormalData(&mesh->mNormals[0].x, 1, usage, sizeof(aiVector3D));
+        buffer.id = meshHelper.vbo.getNormalId();
+        buffer.data = (const char *)mesh->mNormals;
+        buffer.size = numVertices * sizeof(aiVector3D);
+        reserveBuffer(buffer.target, buffer.id, buffer.size, usage);
+        pendingBuffers.push_back(buffer);
+    }
+    if(meshHelper.cachedMesh.hasTexCoords()){
+        const ofVec2f * texCoords = meshHelper.cachedMesh.getTexCoordsPointer();
+        meshHelper.vbo.setTexCoordData(texCoords[0].getPtr(), 1, GL_STATIC_DRAW, sizeof(ofVec2f));
+        buffer.id = meshHelper.vbo.getTexCoordId();
+        buffer.data = (const char *)texCoords;
+        buffer.size = numVertices * sizeof(ofVec2f);
+        buffer.bTexCoords = meshHelper.hasTexture();
+        reserveBuffer(buffer.target, buffer.id, buffer.size, GL_STATIC_DRAW);
+        pendingBuffers.push_back(buffer);
+        buffer.bTexCoords = false;
+    }
+
+    if(!meshHelper.indices.empty()){
+        meshHelper.vbo.setIndexData(&meshHelper.indices[0], 1, GL_STATIC_DRAW);
+        buffer.target = GL_ELEMENT_ARRAY_BUFFER;
+        buffer.id = meshHelper.vbo.getIndexId();
+        buffer.data = (const char *)&meshHelper.indices[0];
+        buffer.size = meshHelper.indices.size() * sizeof(ofIndexType);
+        reserveBuffer(buffer.target, buffer.id, buffer.size, GL_STATIC_DRAW);
+        pendingBuffers.push_back(buffer);
+    }
+}
+
+//-------------------------------------------
+void ofxAssimpModelLoader::setLoadState(ofxAssimpLoadState state){
+    if(importThread) importThread->lock();
+    loadState = state;
+    if(importThread) importThread->unlock();
+}
+
+//-------------------------------------------
+ofxAssimpLoadState ofxAssimpModelLoader::getLoadState(){
+    // a waiting request counts as importing, even while the thread reports
+    // the end of the one before it.
+    if(bQueuedLoad){
+        return OFX_ASSIMP_LOAD_IMPORTING;
+    }
+    return getImportState();
+}
+
+//-------------------------------------------
+ofxAssimpLoadState ofxAssimpModelLoader::getImportState(){
+    if(importThread) importThread->lock();
+    ofxAssimpLoadState state = loadState;
+    if(importThread) importThread->unlock();
+    return state;
+}
+
+//-------------------------------------------
+bool ofxAssimpModelLoader::isLoading(){
+    ofxAssimpLoadState state = getLoadState();
+    return state == OFX_ASSIMP_LOAD_IMPORTING || state == OFX_ASSIMP_LOAD_UPLOADING;
+}
+
+//-------------------------------------------
+void ofxAssimpModelLoader::setUploadBudget(float milliseconds){
+    uploadBudget = milliseconds;
+}
+
+//-------------------------------------------
+unsigned int ofxAssimpModelLoader::getImportFlags(bool optimize){
+	// aiProcess_FlipUVs is for VAR code. Not needed otherwise. Not sure why.
+	unsigned int flags = aiProcessPreset_TargetRealtime_MaxQuality | aiProcess_Triangulate | aiProcess_FlipUVs;
+	if(optimize) flags |=  aiProcess_ImproveCacheLocality | aiProcess_OptimizeGraph |
+			aiProcess_OptimizeMeshes | aiProcess_JoinIdenticalVertices |
+			aiProcess_RemoveRedundantMaterials;
+    return flags;
+}
+
+//-------------------------------------------
+bool ofxAssimpModelLoader::loadModelFromCache(string cachePath, const ofxAssimpMeshCacheSource & source, unsigned int flags){
+    ofxAssimpMeshCache cache;
+    if(!cache.open(cachePath, source, flags)){
+        return false;
+    }
+    ofLogVerbose("ofxAssimpModelLoader") << "loadModelFromCache(): loading \"" << cachePath << "\"";
+
+	normalizeFactor = ofGetWidth() / 2.0;
+    clear();
+    scene.reset();
+
+    const ofxAssimpMeshCacheHeader & header = cache.getHeader();
+    scene_min = aiVector3D(header.sceneMin[0], header.sceneMin[1], header.sceneMin[2]);
+    scene_max = aiVector3D(header.sceneMax[0], header.sceneMax[1], header.sceneMax[2]);
+
+    modelMeshes.resize(cache.getNumMeshes(), ofxAssimpMeshHelper());
+    for(unsigned int i = 0; i < cache.getNumMeshes(); i++){
+        const ofxAssimpMeshCacheEntry & entry = cache.getEntry(i);
+        ofxAssimpMeshHelper & meshHelper = modelMeshes[i];
+
+        meshHelper.name = entry.name;
+        meshHelper.material.setDiffuseColor(ofFloatColor(entry.diffuse[0], entry.diffuse[1], entry.diffuse[2], entry.diffuse[3]));
+        meshHelper.material.setSpecularColor(ofFloatColor(entry.specular[0], entry.specular[1], entry.specular[2], entry.specular[3]));
+        meshHelper.material.setAmbientColor(ofFloatColor(entry.ambient[0], entry.ambient[1], entry.ambient[2], entry.ambient[3]));
+        meshHelper.material.setEmissiveColor(ofFloatColor(entry.emissive[0], entry.emissive[1], entry.emissive[2], entry.emissive[3]));
+        meshHelper.material.setShininess(entry.shininess);
+        meshHelper.blendMode = (ofBlendMode)entry.blendMode;
+        meshHelper.twoSided = entry.twoSided;
+        meshHelper.matrix.set(entry.matrix);
+        if(entry.texturePath[0]){
+            loadMeshTexture(meshHelper, entry.texturePath, textures);
+        }
+
+        // upload straight from the mapped file.
+        int numVertices = entry.numVertices;
+        const ofVec3f * vertices = (const ofVec3f *)cache.getData(entry.verticesOffset);
+        meshHelper.vbo.setVertexData(&vertices[0].x, 3, numVertices, GL_STATIC_DRAW, sizeof(ofVec3f));
+        meshHelper.cachedMesh.addVertices(vertices, numVertices);
+        if(entry.hasNormals){
+            const ofVec3f * normals = (const ofVec3f *)cache.getData(entry.normalsOffset);
+            meshHelper.vbo.setNormalData(&normals[0].x, numVertices, GL_STATIC_DRAW, sizeof(ofVec3f));
+            meshHelper.cachedMesh.addNormals(normals, numVertices);
+        }
+        if(entry.hasColors){
+            const ofFloatColor * colors = (const ofFloatColor *)cache.getData(entry.colorsOffset);
+            meshHelper.vbo.setColorData(&colors[0].r, numVertices, GL_STATIC_DRAW, sizeof(ofFloatColor));
+            meshHelper.cachedMesh.addColors(colors, numVertices);
+        }
+        if(entry.hasTexCoords){
+            const ofVec2f * texCoords = (const ofVec2f *)cache.getData(entry.texCoordsOffset);
+            meshHelper.vbo.setTexCoordData(&texCoords[0].x, numVertices, GL_STATIC_DRAW, sizeof(ofVec2f));
+            meshHelper.cachedMesh.addTexCoords(texCoords, numVertices);
+        }
+
+        const ofIndexType * indices = (const ofIndexType *)cache.getData(entry.indicesOffset);
+        meshHelper.indices.assign(indices, indices + entry.numIndices);
+        if(!meshHelper.indices.empty()){
+            meshHelper.vbo.setIndexData(&meshHelper.indices[0], meshHelper.indices.size(), GL_STATIC_DRAW);
+        }
+        meshHelper.cachedMesh.addIndices(meshHelper.indices);
+        meshHelper.cachedMesh.setMode(OF_PRIMITIVE_TRIANGLES);
+        meshHelper.validCache = true;
+        meshHelper.hasChanged = false;
+    }
+
+    bLoadedFromCache = true;
+    calculateScale();
+    return true;
+}
+
 //-------------------------------------------
 bool ofxAssimpModelLoader::loadModel(ofBuffer & buffer, bool optimize, const char * extension){
 	normalizeFactor = ofGetWidth() / 2.0;
@@ -44,11 +493,7 @@ bool ofxAssimpModelLoader::loadModel(ofBuffer & buffer, bool optimize, const cha
 	aiSetImportPropertyInteger(AI_CONFIG_PP_SBP_REMOVE, aiPrimitiveType_LINE | aiPrimitiveType_POINT );
 	aiSetImportPropertyInteger(AI_CONFIG_PP_PTV_NORMALIZE, true);
 
-	// aiProcess_FlipUVs is for VAR code. Not needed otherwise. Not sure why.
-	unsigned int flags = aiProcessPreset_TargetRealtime_MaxQuality | aiProcess_Triangulate | aiProcess_FlipUVs;
-	if(optimize) flags |=  aiProcess_ImproveCacheLocality | aiProcess_OptimizeGraph |
-			aiProcess_OptimizeMeshes | aiProcess_JoinIdenticalVertices |
-			aiProcess_RemoveRedundantMaterials;
+	unsigned int flags = getImportFlags(optimize);
 
 	scene = shared_ptr<const aiScene>(aiImportFileFromMemory(buffer.getBinaryBuffer(), buffer.size(), flags, extension),aiReleaseImport);
     
@@ -102,7 +547,12 @@ void ofxAssimpModelLoader::calculateDimensions(){
 	ofLogVerbose("ofxAssimpModelLoader") << "calculateDimensions(): inited scene with "
 		<< scene->mNumMeshes << " meshes & " << scene->mNumAnimations << " animations";
 
-	getBoundingBoxWithMinVector(&scene_min, &scene_max);
+	getBoundingBoxWithMinVector(scene.get(), &scene_min, &scene_max);
+	calculateScale();
+}
+
+//-------------------------------------------
+void ofxAssimpModelLoader::calculateScale(){
 	scene_center.x = (scene_min.x + scene_max.x) / 2.0f;
 	scene_center.y = (scene_min.y + scene_max.y) / 2.0f;
 	scene_center.z = (scene_min.z + scene_max.z) / 2.0f;
@@ -153,42 +603,80 @@ void ofxAssimpModelLoader::loadGLResources(){
 
     // create OpenGL buffers and populate them based on each meshes pertinant info.
     for (unsigned int i = 0; i < scene->mNumMeshes; ++i){
-        ofLogVerbose("ofxAssimpModelLoader") << "loadGLResources(): loading mesh " << i;
-        // current mesh we are introspecting
-        aiMesh* mesh = scene->mMeshes[i];
+        loadMeshGLResources(scene.get(), i, modelMeshes[i], textures, file.getEnclosingDirectory());
+    }
+    
+    int numOfAnimations = scene->mNumAnimations;
+    for(int i=0; i<numOfAnimations; i++) {
+        aiAnimation * animation = scene->mAnimations[i];
+        animations.push_back(ofxAssimpAnimation(scene, animation));
+    }
+    buildSkeleton();
 
-        // the current meshHelper we will be populating data into.
-        ofxAssimpMeshHelper & meshHelper = modelMeshes[i];
-        //ofxAssimpMeshHelper meshHelper;
-		
-        //meshHelper.texture = NULL;
+    ofLogVerbose("ofxAssimpModelLoader") << "loadGLResource(): finished";
+}
 
-        // Handle material info
-        aiMaterial* mtl = scene->mMaterials[mesh->mMaterialIndex];
-        aiColor4D dcolor, scolor, acolor, ecolor;
+//-------------------------------------------
+void ofxAssimpModelLoader::loadMeshGLResources(const aiScene * sourceScene, unsigned int meshIndex,
+                                               ofxAssimpMeshHelper & meshHelper,
+                                               vector<ofxAssimpTexture> & textures, string modelFolder){
+    ofLogVerbose("ofxAssimpModelLoader") << "loadGLResources(): loading mesh " << meshIndex;
+    // the texture goes first, texture coordinates depend on its target.
+    string texturePath = getMeshTexturePath(sourceScene, meshIndex, modelFolder);
+    if(!texturePath.empty()){
+        loadMeshTexture(meshHelper, texturePath, textures);
+    }
+    loadMeshData(sourceScene, meshIndex, meshHelper);
 
-        if(AI_SUCCESS == aiGetMaterialColor(mtl, AI_MATKEY_COLOR_DIFFUSE, &dcolor)){
-            meshHelper.material.setDiffuseColor(aiColorToOfColor(dcolor));
-        }
+    aiMesh* mesh = sourceScene->mMeshes[meshIndex];
+    int usage = getMeshUsage(sourceScene);
+    meshHelper.vbo.setVertexData(&mesh->mVertices[0].x,3,mesh->mNumVertices,usage,sizeof(aiVector3D));
+    if(mesh->HasVertexColors(0)){
+    	meshHelper.vbo.setColorData(&mesh->mColors[0][0].r,mesh->mNumVertices,GL_STATIC_DRAW,sizeof(aiColor4D));
+    }
+    if(mesh->HasNormals()){
+    	meshHelper.vbo.setNormalData(&mesh->mNormals[0].x,mesh->mNumVertices,usage,sizeof(aiVector3D));
+    }
+    if (meshHelper.cachedMesh.hasTexCoords()){			
+    	meshHelper.vbo.setTexCoordData(meshHelper.cachedMesh.getTexCoordsPointer()[0].getPtr(),mesh->mNumVertices,GL_STATIC_DRAW,sizeof(ofVec2f));
+    }
+    if(!meshHelper.indices.empty()){
+    	meshHelper.vbo.setIndexData(&meshHelper.indices[0],meshHelper.indices.size(),GL_STATIC_DRAW);
+    }
+}
 
-        if(AI_SUCCESS == aiGetMaterialColor(mtl, AI_MATKEY_COLOR_SPECULAR, &scolor)){
-        	meshHelper.material.setSpecularColor(aiColorToOfColor(scolor));
-        }
+//-------------------------------------------
+void ofxAssimpModelLoader::loadMeshData(const aiScene * sourceScene, unsigned int meshIndex,
+                                        ofxAssimpMeshHelper & meshHelper){
+    // current mesh we are introspecting
+    aiMesh* mesh = sourceScene->mMeshes[meshIndex];
 
-        if(AI_SUCCESS == aiGetMaterialColor(mtl, AI_MATKEY_COLOR_AMBIENT, &acolor)){
-        	meshHelper.material.setAmbientColor(aiColorToOfColor(acolor));
-        }
+    // Handle material info
+    aiMaterial* mtl = sourceScene->mMaterials[mesh->mMaterialIndex];
+    aiColor4D dcolor, scolor, acolor, ecolor;
 
-        if(AI_SUCCESS == aiGetMaterialColor(mtl, AI_MATKEY_COLOR_EMISSIVE, &ecolor)){
-        	meshHelper.material.setEmissiveColor(aiColorToOfColor(ecolor));
-        }
+    if(AI_SUCCESS == aiGetMaterialColor(mtl, AI_MATKEY_COLOR_DIFFUSE, &dcolor)){
+        meshHelper.material.setDiffuseColor(aiColorToOfColor(dcolor));
+    }
+
+    if(AI_SUCCESS == aiGetMaterialColor(mtl, AI_MATKEY_COLOR_SPECULAR, &scolor)){
+    	meshHelper.material.setSpecularColor(aiColorToOfColor(scolor));
+    }
+
+    if(AI_SUCCESS == aiGetMaterialColor(mtl, AI_MATKEY_COLOR_AMBIENT, &acolor)){
+    	meshHelper.material.setAmbientColor(aiColorToOfColor(acolor));
+    }
+
+    if(AI_SUCCESS == aiGetMaterialColor(mtl, AI_MATKEY_COLOR_EMISSIVE, &ecolor)){
+    	meshHelper.material.setEmissiveColor(aiColorToOfColor(ecolor));
+    }
 
-        float shininess;
-        if(AI_SUCCESS == aiGetMaterialFloat(mtl, AI_MATKEY_SHININESS, &shininess)){
+    float shininess;
+    if(AI_SUCCESS == aiGetMaterialFloat(mtl, AI_MATKEY_SHININESS, &shininess)){
 			meshHelper.material.setShininess(shininess);
 		}
 
-        int blendMode;
+    int blendMode;
 		if(AI_SUCCESS == aiGetMaterialInteger(mtl, AI_MATKEY_BLEND_FUNC, &blendMode)){
 			if(blendMode==aiBlendMode_Default){
 				meshHelper.blendMode=OF_BLENDMODE_ALPHA;
@@ -197,119 +685,108 @@ void ofxAssimpModelLoader::loadGLResources(){
 			}
 		}
 
-        // Culling
-        unsigned int max = 1;
-        int two_sided;
-        if((AI_SUCCESS == aiGetMaterialIntegerArray(mtl, AI_MATKEY_TWOSIDED, &two_sided, &max)) && two_sided)
-            meshHelper.twoSided = true;
-        else
-            meshHelper.twoSided = false;
-
-        // Load Textures
-        int texIndex = 0;
-        aiString texPath;
-
-        // TODO: handle other aiTextureTypes
-        if(AI_SUCCESS == mtl->GetTexture(aiTextureType_DIFFUSE, texIndex, &texPath)){
-            ofLogVerbose("ofxAssimpModelLoader") << "loadGLResource(): loading image from \"" << texPath.data << "\"";
-            string modelFolder = file.getEnclosingDirectory();
-            string relTexPath = ofFilePath::getEnclosingDirectory(texPath.data,false);
-            string texFile = ofFilePath::getFileName(texPath.data);
-            string realPath = modelFolder + relTexPath  + texFile;
-            
-            if(ofFile::doesFileExist(realPath) == false) {
-                ofLogError("ofxAssimpModelLoader") << "loadGLResource(): texture doesn't exist: \""
-					<< file.getFileName() + "\" in \"" << realPath << "\"";
-            }
-            
-            ofxAssimpTexture assimpTexture;
-            bool bTextureAlreadyExists = false;
-            for(int j=0; j<textures.size(); j++) {
-                assimpTexture = textures[j];
-                if(assimpTexture.getTexturePath() == realPath) {
-                    bTextureAlreadyExists = true;
-                    break;
-                }
-            }
-            if(bTextureAlreadyExists) {
-                meshHelper.assimpTexture = assimpTexture;
-                ofLogVerbose("ofxAssimpModelLoader") << "loadGLResource(): texture already loaded: \""
-					<< file.getFileName() + "\" from \"" << realPath << "\"";
-            } else {
-                ofTexture texture;
-                bool bTextureLoadedOk = ofLoadImage(texture, realPath);
-                if(bTextureLoadedOk) {
-                    textures.push_back(ofxAssimpTexture(texture, realPath));
-                    assimpTexture = textures.back();
-                    meshHelper.assimpTexture = assimpTexture;
-                    ofLogVerbose("ofxAssimpModelLoader") << "loadGLResource(): texture loaded, dimensions: "
-						<< texture.getWidth() << "x" << texture.getHeight();
-                } else {
-                    ofLogError("ofxAssimpModelLoader") << "loadGLResource(): couldn't load texture: \""
-						<< file.getFileName() + "\" from \"" << realPath << "\"";
-                }
-            }
-        }
+    // Culling
+    unsigned int max = 1;
+    int two_sided;
+    if((AI_SUCCESS == aiGetMaterialIntegerArray(mtl, AI_MATKEY_TWOSIDED, &two_sided, &max)) && two_sided)
+        meshHelper.twoSided = true;
+    else
+        meshHelper.twoSided = false;
+
+    meshHelper.mesh = mesh;
+    meshHelper.name = mesh->mName.data;
+    aiMeshToOfMesh(mesh, meshHelper.cachedMesh, &meshHelper);
+    meshHelper.cachedMesh.setMode(OF_PRIMITIVE_TRIANGLES);
+    meshHelper.validCache = true;
+    meshHelper.hasChanged = false;
+
+    meshHelper.animatedPos.resize(mesh->mNumVertices);
+    if(mesh->HasNormals()){
+    	meshHelper.animatedNorm.resize(mesh->mNumVertices);
+    }
 
-        meshHelper.mesh = mesh;
-        aiMeshToOfMesh(mesh, meshHelper.cachedMesh, &meshHelper);
-        meshHelper.cachedMesh.setMode(OF_PRIMITIVE_TRIANGLES);
-        meshHelper.validCache = true;
-        meshHelper.hasChanged = false;
 
-        meshHelper.animatedPos.resize(mesh->mNumVertices);
-        if(mesh->HasNormals()){
-        	meshHelper.animatedNorm.resize(mesh->mNumVertices);
+    meshHelper.indices.resize(mesh->mNumFaces * 3);
+    int j=0;
+    for (unsigned int x = 0; x < mesh->mNumFaces; ++x){
+			for (unsigned int a = 0; a < mesh->mFaces[x].mNumIndices; ++a){
+				meshHelper.indices[j++]=mesh->mFaces[x].mIndices[a];
+			}
+		}
+}
+
+//-------------------------------------------
+string ofxAssimpModelLoader::getMeshTexturePath(const aiScene * sourceScene, unsigned int meshIndex, string modelFolder){
+    aiMesh* mesh = sourceScene->mMeshes[meshIndex];
+    aiMaterial* mtl = sourceScene->mMaterials[mesh->mMaterialIndex];
+    string texturePath;
+    int texIndex = 0;
+    aiString texPath;
+
+    // TODO: handle other aiTextureTypes
+    if(AI_SUCCESS == mtl->GetTexture(aiTextureType_DIFFUSE, texIndex, &texPath)){
+        ofLogVerbose("ofxAssimpModelLoader") << "getMeshTexturePath(): texture \"" << texPath.data << "\"";
+        string relTexPath = ofFilePath::getEnclosingDirectory(texPath.data,false);
+        string texFile = ofFilePath::getFileName(texPath.data);
+        string realPath = modelFolder + relTexPath  + texFile;
+        
+        if(ofFile::doesFileExist(realPath) == false) {
+            ofLogError("ofxAssimpModelLoader") << "getMeshTexturePath(): texture doesn't exist: \""
+					<< modelFolder << "\" in \"" << realPath << "\"";
         }
+        
+        texturePath = realPath;
+    }
 
+    return texturePath;
+}
 
-        int usage;
-        if(getAnimationCount()){
+//-------------------------------------------
+int ofxAssimpModelLoader::getMeshUsage(const aiScene * sourceScene){
+    // animated meshes are updated every frame.
+    if(sourceScene->mNumAnimations){
 #ifndef TARGET_OPENGLES
-        	if(!ofIsGLProgrammableRenderer()){
-        		usage = GL_STATIC_DRAW;
-        	}else{
-        		usage = GL_STREAM_DRAW;
-        	}
+    	if(!ofIsGLProgrammableRenderer()){
+    		return GL_STATIC_DRAW;
+    	}else{
+    		return GL_STREAM_DRAW;
+    	}
 #else
-        	usage = GL_DYNAMIC_DRAW;
+    	return GL_DYNAMIC_DRAW;
 #endif
-        }else{
-        	usage = GL_STATIC_DRAW;
-
-        }
+    }
+    return GL_STATIC_DRAW;
+}
 
-        meshHelper.vbo.setVertexData(&mesh->mVertices[0].x,3,mesh->mNumVertices,usage,sizeof(aiVector3D));
-        if(mesh->HasVertexColors(0)){
-        	meshHelper.vbo.setColorData(&mesh->mColors[0][0].r,mesh->mNumVertices,GL_STATIC_DRAW,sizeof(aiColor4D));
-        }
-        if(mesh->HasNormals()){
-        	meshHelper.vbo.setNormalData(&mesh->mNormals[0].x,mesh->mNumVertices,usage,sizeof(aiVector3D));
-        }
-        if (meshHelper.cachedMesh.hasTexCoords()){			
-        	meshHelper.vbo.setTexCoordData(meshHelper.cachedMesh.getTexCoordsPointer()[0].getPtr(),mesh->mNumVertices,GL_STATIC_DRAW,sizeof(ofVec2f));
+//-------------------------------------------
+void ofxAssimpModelLoader::loadMeshTexture(ofxAssimpMeshHelper & meshHelper, string realPath, vector<ofxAssimpTexture> & textures){
+    ofxAssimpTexture assimpTexture;
+    bool bTextureAlreadyExists = false;
+    for(int j=0; j<textures.size(); j++) {
+        assimpTexture = textures[j];
+        if(assimpTexture.getTexturePath() == realPath) {
+            bTextureAlreadyExists = true;
+            break;
         }
-
-        meshHelper.indices.resize(mesh->mNumFaces * 3);
-        int j=0;
-        for (unsigned int x = 0; x < mesh->mNumFaces; ++x){
-			for (unsigned int a = 0; a < mesh->mFaces[x].mNumIndices; ++a){
-				meshHelper.indices[j++]=mesh->mFaces[x].mIndices[a];
-			}
-		}
-
-        meshHelper.vbo.setIndexData(&meshHelper.indices[0],meshHelper.indices.size(),GL_STATIC_DRAW);
-
-        //modelMeshes.push_back(meshHelper);
     }
-    
-    int numOfAnimations = scene->mNumAnimations;
-    for(int i=0; i<numOfAnimations; i++) {
-        aiAnimation * animation = scene->mAnimations[i];
-        animations.push_back(ofxAssimpAnimation(scene, animation));
+    if(bTextureAlreadyExists) {
+        meshHelper.assimpTexture = assimpTexture;
+        ofLogVerbose("ofxAssimpModelLoader") << "loadGLResource(): texture already loaded: \""
+					<< file.getFileName() + "\" from \"" << realPath << "\"";
+    } else {
+        ofTexture texture;
+        bool bTextureLoadedOk = ofLoadImage(texture, realPath);
+        if(bTextureLoadedOk) {
+            textures.push_back(ofxAssimpTexture(texture, realPath));
+            assimpTexture = textures.back();
+            meshHelper.assimpTexture = assimpTexture;
+            ofLogVerbose("ofxAssimpModelLoader") << "loadGLResource(): texture loaded, dimensions: "
+						<< texture.getWidth() << "x" << texture.getHeight();
+        } else {
+            ofLogError("ofxAssimpModelLoader") << "loadGLResource(): couldn't load texture: \""
+						<< file.getFileName() + "\" from \"" << realPath << "\"";
+        }
     }
-
-    ofLogVerbose("ofxAssimpModelLoader") << "loadGLResource(): finished";
 }
 
 //-------------------------------------------
@@ -319,6 +796,7 @@ void ofxAssimpModelLoader::clear(){
 
     // clear out everything.
     modelMeshes.clear();
+    renderQueue.clear();
     animations.clear();
     pos.set(0,0,0);
     scale.set(1,1,1);
@@ -332,6 +810,7 @@ void ofxAssimpModelLoader::clear(){
     bUsingNormals = true;
     bUsingTextures = true;
     bUsingColors = true;
+    bLoadedFromCache = false;
 
     currentAnimation = -1;
 
@@ -343,6 +822,8 @@ void ofxAssimpModelLoader::clear(){
 
 //------------------------------------------- update.
 void ofxAssimpModelLoader::update() {
+    startQueuedLoad();
+    uploadPendingModel();
 	if(!scene) return;
     updateAnimations();
     updateMeshes(scene->mRootNode, ofMatrix4x4());
@@ -354,8 +835,20 @@ void ofxAssimpModelLoader::update() {
 }
 
 void ofxAssimpModelLoader::updateAnimations() {
+    // advance every animation, sample the ones that moved in one batch, then
+    // pose the nodes in order so later animations still win shared nodes.
+    animationJobs.clear();
+    sampledAnimations.clear();
     for(unsigned int i=0; i<animations.size(); i++) {
-        animations[i].update();
+        ofxAssimpAnimationJob job;
+        if(animations[i].update(job)) {
+            animationJobs.push_back(job);
+            sampledAnimations.push_back(i);
+        }
+    }
+    ofxAssimpAnimationTracks::sampleBatch(animationJobs);
+    for(unsigned int i=0; i<sampledAnimations.size(); i++) {
+        animations[sampledAnimations[i]].applyTransforms();
     }
 }
 
@@ -381,63 +874,218 @@ void ofxAssimpModelLoader::updateMeshes(aiNode * node, ofMatrix4x4 parentMatrix)
 }
 
 void ofxAssimpModelLoader::updateBones() {
-    // update mesh position for the animation
-	for(unsigned int i=0; i<modelMeshes.size(); ++i) {
-		// current mesh we are introspecting
-		const aiMesh* mesh = modelMeshes[i].mesh;
-        
-		// calculate bone matrices
-		vector<aiMatrix4x4> boneMatrices(mesh->mNumBones);
-		for(unsigned int a=0; a<mesh->mNumBones; ++a) {
-			const aiBone* bone = mesh->mBones[a];
-            
-			// find the corresponding node by again looking recursively through the node hierarchy for the same name
-			aiNode* node = scene->mRootNode->FindNode(bone->mName);
-            
-			// start with the mesh-to-bone matrix
-			boneMatrices[a] = bone->mOffsetMatrix;
-			// and now append all node transformations down the parent chain until we're back at mesh coordinates again
-			const aiNode* tempNode = node;
-			while(tempNode) {
-				// check your matrix multiplication order here!!!
-				boneMatrices[a] = tempNode->mTransformation * boneMatrices[a];
-				// boneMatrices[a] = boneMatrices[a] * tempNode->mTransformation;
-				tempNode = tempNode->mParent;
-			}
-			modelMeshes[i].hasChanged = true;
-			modelMeshes[i].validCache = false;
-		}
-        
-		modelMeshes[i].animatedPos.assign(modelMeshes[i].animatedPos.size(),0);
-		if(mesh->HasNormals()){
-			modelMeshes[i].animatedNorm.assign(modelMeshes[i].animatedNorm.size(),0);
-		}
-		// loop through all vertex weights of all bones
-		for(unsigned int a=0; a<mesh->mNumBones; ++a) {
-			const aiBone* bone = mesh->mBones[a];
-			const aiMatrix4x4& posTrafo = boneMatrices[a];
-            
-			for(unsigned int b=0; b<bone->mNumWeights; ++b) {
-				const aiVertexWeight& weight = bone->mWeights[b];
-                
-				size_t vertexId = weight.mVertexId;
-				const aiVector3D& srcPos = mesh->mVertices[vertexId];
-                
-				modelMeshes[i].animatedPos[vertexId] += weight.mWeight * (posTrafo * srcPos);
-			}
-			if(mesh->HasNormals()){
-				// 3x3 matrix, contains the bone matrix without the translation, only with rotation and possibly scaling
-				aiMatrix3x3 normTrafo = aiMatrix3x3( posTrafo);
-				for(unsigned int b=0; b<bone->mNumWeights; ++b) {
-					const aiVertexWeight& weight = bone->mWeights[b];
-					size_t vertexId = weight.mVertexId;
-                    
-					const aiVector3D& srcNorm = mesh->mNormals[vertexId];
-					modelMeshes[i].animatedNorm[vertexId] += weight.mWeight * (normTrafo * srcNorm);
-				}
-			}
-		}
-	}
+    // global transforms for the whole hierarchy in one pass; parents come
+    // before their children so each node needs one multiply.
+    for(unsigned int i=0; i<skeletonNodes.size(); ++i) {
+        int parent = skeletonParents[i];
+        if(parent < 0) {
+            skeletonTransforms[i] = skeletonNodes[i]->mTransformation;
+        } else {
+            skeletonTransforms[i] = skeletonTransforms[parent] * skeletonNodes[i]->mTransformation;
+        }
+    }
+
+    // meshes are independent of each other from here on.
+    int numMeshes = modelMeshes.size();
+#ifdef _OPENMP
+    #pragma omp parallel for schedule(dynamic)
+#endif
+    for(int i=0; i<numMeshes; ++i) {
+        updateBonePalette(modelMeshes[i]);
+
+        // with GPU skinning the palette is all the shader needs; vertices
+        // are only skinned here if someone asks for the animated mesh.
+        if(!bUsingGPUSkinning && modelMeshes[i].mesh->mNumBones) {
+            skinMesh(modelMeshes[i]);
+            modelMeshes[i].hasChanged = true;
+        }
+    }
+}
+
+void ofxAssimpModelLoader::updateBonePalette(ofxAssimpMeshHelper & meshHelper) {
+    const aiMesh* mesh = meshHelper.mesh;
+    if(mesh->mNumBones == 0) {
+        return;
+    }
+
+    // bone matrices: mesh-to-bone offset followed by the node's global transform.
+    for(unsigned int a=0; a<mesh->mNumBones; ++a) {
+        meshHelper.boneMatrices[a] = skeletonTransforms[meshHelper.boneNodes[a]] * mesh->mBones[a]->mOffsetMatrix;
+    }
+    meshHelper.validCache = false;
+    meshHelper.validSkin = false;
+}
+
+void ofxAssimpModelLoader::skinMesh(ofxAssimpMeshHelper & meshHelper) {
+    const aiMesh* mesh = meshHelper.mesh;
+    if(mesh->mNumBones == 0 || meshHelper.validSkin) {
+        return;
+    }
+    meshHelper.validSkin = true;
+
+    const unsigned int * indices = &meshHelper.boneIndices[0];
+    const float * weights = &meshHelper.boneWeights[0];
+    const aiMatrix4x4 * palette = &meshHelper.boneMatrices[0];
+    bool hasNormals = mesh->HasNormals();
+
+    // vertex by vertex: blend the (up to) 4 bone matrices, then transform.
+    for(unsigned int v=0; v<mesh->mNumVertices; ++v) {
+        const aiVector3D & srcPos = mesh->mVertices[v];
+#if defined(__SSE__)
+        // columns of the blended 3x4 matrix.
+        __m128 c0 = _mm_setzero_ps();
+        __m128 c1 = _mm_setzero_ps();
+        __m128 c2 = _mm_setzero_ps();
+        __m128 c3 = _mm_setzero_ps();
+        for(int k=0; k<4; ++k) {
+            float w = weights[4 * v + k];
+            if(w == 0) break;
+            const aiMatrix4x4 & m = palette[indices[4 * v + k]];
+            __m128 weight = _mm_set1_ps(w);
+            c0 = _mm_add_ps(c0, _mm_mul_ps(weight, _mm_setr_ps(m.a1, m.b1, m.c1, 0)));
+            c1 = _mm_add_ps(c1, _mm_mul_ps(weight, _mm_setr_ps(m.a2, m.b2, m.c2, 0)));
+            c2 = _mm_add_ps(c2, _mm_mul_ps(weight, _mm_setr_ps(m.a3, m.b3, m.c3, 0)));
+            c3 = _mm_add_ps(c3, _mm_mul_ps(weight, _mm_setr_ps(m.a4, m.b4, m.c4, 0)));
+        }
+        float out[4];
+        __m128 p = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(srcPos.x)),
+                                         _mm_mul_ps(c1, _mm_set1_ps(srcPos.y))),
+                              _mm_add_ps(_mm_mul_ps(c2, _mm_set1_ps(srcPos.z)), c3));
+        _mm_storeu_ps(out, p);
+        meshHelper.animatedPos[v].Set(out[0], out[1], out[2]);
+        if(hasNormals) {
+            const aiVector3D & srcNorm = mesh->mNormals[v];
+            __m128 n = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c0, _mm_set1_ps(srcNorm.x)),
+                                             _mm_mul_ps(c1, _mm_set1_ps(srcNorm.y))),
+                                  _mm_mul_ps(c2, _mm_set1_ps(srcNorm.z)));
+            _mm_storeu_ps(out, n);
+            meshHelper.animatedNorm[v].Set(out[0], out[1], out[2]);
+        }
+#else
+        aiMatrix4x4 blended;
+        blended.a1 = blended.b2 = blended.c3 = blended.d4 = 0;
+        for(int k=0; k<4; ++k) {
+            float w = weights[4 * v + k];
+            if(w == 0) break;
+            const aiMatrix4x4 & m = palette[indices[4 * v + k]];
+            for(int r=0; r<3; ++r) {
+                for(int c=0; c<4; ++c) {
+                    blended[r][c] += w * m[r][c];
+                }
+            }
+        }
+        meshHelper.animatedPos[v] = blended * srcPos;
+        if(hasNormals) {
+            // 3x3 matrix, contains the bone matrix without the translation, only with rotation and possibly scaling
+            meshHelper.animatedNorm[v] = aiMatrix3x3(blended) * mesh->mNormals[v];
+        }
+#endif
+    }
+}
+
+void ofxAssimpModelLoader::buildSkeleton() {
+    skeletonNodes.clear();
+    skeletonParents.clear();
+    if(!scene) {
+        return;
+    }
+
+    // breadth-first, so every node comes after its parent.
+    map<string, int> nodeIndices;
+    skeletonNodes.push_back(scene->mRootNode);
+    skeletonParents.push_back(-1);
+    for(unsigned int i=0; i<skeletonNodes.size(); ++i) {
+        const aiNode * node = skeletonNodes[i];
+        nodeIndices[node->mName.data] = i;
+        for(unsigned int c=0; c<node->mNumChildren; ++c) {
+            skeletonNodes.push_back(node->mChildren[c]);
+            skeletonParents.push_back(i);
+        }
+    }
+    skeletonTransforms.resize(skeletonNodes.size());
+
+    for(unsigned int i=0; i<modelMeshes.size(); ++i) {
+        ofxAssimpMeshHelper & meshHelper = modelMeshes[i];
+        const aiMesh * mesh = meshHelper.mesh;
+        meshHelper.boneNodes.assign(mesh->mNumBones, 0);
+        meshHelper.boneMatrices.resize(mesh->mNumBones);
+        meshHelper.boneIndices.assign(mesh->mNumVertices * 4, 0);
+        meshHelper.boneWeights.assign(mesh->mNumVertices * 4, 0);
+
+        for(unsigned int a=0; a<mesh->mNumBones; ++a) {
+            const aiBone * bone = mesh->mBones[a];
+            map<string, int>::iterator it = nodeIndices.find(bone->mName.data);
+            if(it != nodeIndices.end()) {
+                meshHelper.boneNodes[a] = it->second;
+            } else {
+                ofLogWarning("ofxAssimpModelLoader") << "buildSkeleton(): no node for bone \"" << bone->mName.data << "\"";
+            }
+
+            // keep the 4 heaviest influences per vertex, sorted heaviest first.
+            for(unsigned int b=0; b<bone->mNumWeights; ++b) {
+                const aiVertexWeight & weight = bone->mWeights[b];
+                unsigned int * indices = &meshHelper.boneIndices[4 * weight.mVertexId];
+                float * weights = &meshHelper.boneWeights[4 * weight.mVertexId];
+                int k = 3;
+                if(weight.mWeight <= weights[k]) continue;
+                while(k > 0 && weights[k - 1] < weight.mWeight) {
+                    weights[k] = weights[k - 1];
+                    indices[k] = indices[k - 1];
+                    k--;
+                }
+                weights[k] = weight.mWeight;
+                indices[k] = a;
+            }
+        }
+
+        // renormalize vertices that lost influences.
+        for(unsigned int v=0; v<mesh->mNumVertices && mesh->mNumBones; ++v) {
+            float * weights = &meshHelper.boneWeights[4 * v];
+            float sum = weights[0] + weights[1] + weights[2] + weights[3];
+            if(sum > 0) {
+                for(int k=0; k<4; ++k) {
+                    weights[k] /= sum;
+                }
+            }
+        }
+    }
+
+    uploadSkinningAttributes();
+}
+
+void ofxAssimpModelLoader::uploadSkinningAttributes() {
+    if(!bUsingGPUSkinning || !scene) {
+        return;
+    }
+    for(unsigned int i=0; i<modelMeshes.size(); ++i) {
+        if(modelMeshes[i].boneMatrices.size() > OFX_ASSIMP_MAX_GPU_BONES) {
+            ofLogWarning("ofxAssimpModelLoader") << "uploadSkinningAttributes(): mesh " << i << " has "
+                << modelMeshes[i].boneMatrices.size() << " bones, more than the shader's "
+                << OFX_ASSIMP_MAX_GPU_BONES << ", skinning on the CPU";
+            disableGPUSkinning();
+            return;
+        }
+    }
+
+    for(unsigned int i=0; i<modelMeshes.size(); ++i) {
+        ofxAssimpMeshHelper & meshHelper = modelMeshes[i];
+        const aiMesh * mesh = meshHelper.mesh;
+        if(mesh->mNumBones == 0) {
+            continue;
+        }
+
+        // GL 3.2 attributes here are float, so indices go up as floats.
+        vector<float> indices(meshHelper.boneIndices.begin(), meshHelper.boneIndices.end());
+        meshHelper.vbo.setAttributeData(OFX_ASSIMP_BONE_INDEX_ATTRIBUTE, &indices[0], 4, mesh->mNumVertices, GL_STATIC_DRAW, 4 * sizeof(float));
+        meshHelper.vbo.setAttributeData(OFX_ASSIMP_BONE_WEIGHT_ATTRIBUTE, &meshHelper.boneWeights[0], 4, mesh->mNumVertices, GL_STATIC_DRAW, 4 * sizeof(float));
+
+        // back to the bind pose, in case CPU skinning has been writing into the VBO.
+        meshHelper.vbo.updateVertexData(&mesh->mVertices[0].x, mesh->mNumVertices);
+        if(mesh->HasNormals()) {
+            meshHelper.vbo.updateNormalData(&mesh->mNormals[0].x, mesh->mNumVertices);
+        }
+        meshHelper.hasChanged = false;
+    }
 }
 
 void ofxAssimpModelLoader::updateGLResources(){
@@ -572,7 +1220,7 @@ ofxAssimpMeshHelper & ofxAssimpModelLoader::getMeshHelper(int meshIndex) {
 }
 
 //-------------------------------------------
-void ofxAssimpModelLoader::getBoundingBoxWithMinVector(struct aiVector3D* min, struct aiVector3D* max)
+void ofxAssimpModelLoader::getBoundingBoxWithMinVector(const aiScene * sourceScene, struct aiVector3D* min, struct aiVector3D* max)
 {
 	struct aiMatrix4x4 trafo;
 	aiIdentityMatrix4(&trafo);
@@ -580,11 +1228,11 @@ void ofxAssimpModelLoader::getBoundingBoxWithMinVector(struct aiVector3D* min, s
 	min->x = min->y = min->z =  1e10f;
 	max->x = max->y = max->z = -1e10f;
 
-    this->getBoundingBoxForNode(scene->mRootNode, min, max, &trafo);
+    this->getBoundingBoxForNode(sourceScene, sourceScene->mRootNode, min, max, &trafo);
 }
 
 //-------------------------------------------
-void ofxAssimpModelLoader::getBoundingBoxForNode(const struct aiNode* nd,  struct aiVector3D* min, struct aiVector3D* max, struct aiMatrix4x4* trafo)
+void ofxAssimpModelLoader::getBoundingBoxForNode(const aiScene * sourceScene, const struct aiNode* nd,  struct aiVector3D* min, struct aiVector3D* max, struct aiMatrix4x4* trafo)
 {
 	struct aiMatrix4x4 prev;
 	unsigned int n = 0, t;
@@ -593,7 +1241,7 @@ void ofxAssimpModelLoader::getBoundingBoxForNode(const struct aiNode* nd,  struc
 	aiMultiplyMatrix4(trafo,&nd->mTransformation);
 
 	for (; n < nd->mNumMeshes; ++n){
-		const struct aiMesh* mesh = scene->mMeshes[nd->mMeshes[n]];
+		const struct aiMesh* mesh = sourceScene->mMeshes[nd->mMeshes[n]];
 		for (t = 0; t < mesh->mNumVertices; ++t){
         	struct aiVector3D tmp = mesh->mVertices[t];
 			aiTransformVecByMatrix4(&tmp,trafo);
@@ -610,7 +1258,7 @@ void ofxAssimpModelLoader::getBoundingBoxForNode(const struct aiNode* nd,  struc
 	}
 
 	for (n = 0; n < nd->mNumChildren; ++n){
-		this->getBoundingBoxForNode(nd->mChildren[n], min, max, trafo);
+		this->getBoundingBoxForNode(sourceScene, nd->mChildren[n], min, max, trafo);
 	}
 
 	*trafo = prev;
@@ -677,7 +1325,7 @@ void ofxAssimpModelLoader::drawVertices(){
 
 //-------------------------------------------
 void ofxAssimpModelLoader::draw(ofPolyRenderMode renderType) {
-    if(scene == NULL) {
+    if(scene == NULL && !bLoadedFromCache) {
         return;
     }
     
@@ -695,59 +1343,118 @@ void ofxAssimpModelLoader::draw(ofPolyRenderMode renderType) {
     ofPushMatrix();
     ofMultMatrix(modelMatrix);
     
-    for(unsigned int i=0; i<modelMeshes.size(); i++) {
-        ofxAssimpMeshHelper & mesh = modelMeshes[i];
+    bool bSkinning = bUsingGPUSkinning && hasAnimations();
+    GLint paletteLocation = -1;
+    if(bSkinning){
+        skinningShader.begin();
+        paletteLocation = skinningShader.getUniformLocation("bones");
+    }
+    
+    // static meshes never move, so the queue can merge them.
+    if(!renderQueue.isBuilt()){
+        renderQueue.build(modelMeshes, !hasAnimations());
+    }
+    
+    // batches are sorted by state; only touch GL when it changes.
+    ofTexture * boundTexture = NULL;
+    ofMaterial * boundMaterial = NULL;
+    int boundMaterialIndex = -1;
+    int cullFace = -1;
+    int blendMode = -1;
+    const ofMatrix4x4 * currentMatrix = NULL;
+    ofMatrix4x4 identity;
+    
+    vector<ofxAssimpDrawBatch> & batches = renderQueue.getBatches();
+    for(unsigned int i=0; i<batches.size(); i++) {
+        ofxAssimpDrawBatch & batch = batches[i];
+        ofxAssimpMeshHelper & mesh = modelMeshes[batch.meshIndex];
         
-        ofPushMatrix();
-        ofMultMatrix(mesh.matrix);
+        const ofMatrix4x4 & matrix = batch.merged ? identity : mesh.matrix;
+        if(currentMatrix == NULL || memcmp(currentMatrix->getPtr(), matrix.getPtr(), 16 * sizeof(float)) != 0){
+            if(currentMatrix != NULL){
+                ofPopMatrix();
+            }
+            ofPushMatrix();
+            ofMultMatrix(matrix);
+            currentMatrix = &matrix;
+        }
         
-        if(bUsingTextures){
-            if(mesh.hasTexture()) {
-                mesh.getTextureRef().bind();
+        ofTexture * texture = (bUsingTextures && mesh.hasTexture()) ? &mesh.getTextureRef() : NULL;
+        if(texture != boundTexture) {
+            if(boundTexture != NULL){
+                boundTexture->unbind();
+            }
+            if(texture != NULL){
+                texture->bind();
             }
+            boundTexture = texture;
         }
         
-        if(bUsingMaterials){
+        if(bUsingMaterials && batch.key.material != boundMaterialIndex){
+            if(boundMaterial != NULL){
+                boundMaterial->end();
+            }
             mesh.material.begin();
+            boundMaterial = &mesh.material;
+            boundMaterialIndex = batch.key.material;
+        }
+        
+        if((int)mesh.twoSided != cullFace) {
+            if(mesh.twoSided) {
+                glEnable(GL_CULL_FACE);
+            }
+            else {
+                glDisable(GL_CULL_FACE);
+            }
+            cullFace = mesh.twoSided;
         }
         
-        if(mesh.twoSided) {
-            glEnable(GL_CULL_FACE);
+        if((int)mesh.blendMode != blendMode) {
+            ofEnableBlendMode(mesh.blendMode);
+            blendMode = mesh.blendMode;
         }
-        else {
-            glDisable(GL_CULL_FACE);
+        
+        if(bSkinning){
+            bool skinned = !mesh.boneMatrices.empty();
+            skinningShader.setUniform1f("skinned", skinned ? 1 : 0);
+            if(skinned){
+                // aiMatrix4x4 is row-major.
+                glUniformMatrix4fv(paletteLocation, mesh.boneMatrices.size(), GL_TRUE, &mesh.boneMatrices[0].a1);
+            }
         }
         
-        ofEnableBlendMode(mesh.blendMode);
+        ofVbo & vbo = batch.merged ? batch.vbo : mesh.vbo;
 #ifndef TARGET_OPENGLES
-        mesh.vbo.drawElements(GL_TRIANGLES,mesh.indices.size());
+        vbo.drawElements(GL_TRIANGLES,batch.numIndices);
 #else
         switch(renderType){
 		    case OF_MESH_FILL:
-		    	mesh.vbo.drawElements(GL_TRIANGLES,mesh.indices.size());
+		    	vbo.drawElements(GL_TRIANGLES,batch.numIndices);
 		    	break;
 		    case OF_MESH_WIREFRAME:
-		    	mesh.vbo.drawElements(GL_LINES,mesh.indices.size());
+		    	vbo.drawElements(GL_LINES,batch.numIndices);
 		    	break;
 		    case OF_MESH_POINTS:
-		    	mesh.vbo.drawElements(GL_POINTS,mesh.indices.size());
+		    	vbo.drawElements(GL_POINTS,batch.numIndices);
 		    	break;
         }
 #endif
-        
-        if(bUsingTextures){
-            if(mesh.hasTexture()) {
-            	 mesh.getTextureRef().unbind();
-            }
-        }
-        
-        if(bUsingMaterials){
-            mesh.material.end();
-        }
-        
+    }
+    
+    if(boundTexture != NULL){
+        boundTexture->unbind();
+    }
+    if(boundMaterial != NULL){
+        boundMaterial->end();
+    }
+    if(currentMatrix != NULL){
         ofPopMatrix();
     }
     
+    if(bSkinning){
+        skinningShader.end();
+    }
+    
     ofPopMatrix();
 
     if(!ofGetGLProgrammableRenderer()){
@@ -761,25 +1468,33 @@ void ofxAssimpModelLoader::draw(ofPolyRenderMode renderType) {
 
 //-------------------------------------------
 vector<string> ofxAssimpModelLoader::getMeshNames(){
-	vector<string> names(scene->mNumMeshes);
-	for(int i=0; i<(int)scene->mNumMeshes; i++){
-		names[i] = scene->mMeshes[i]->mName.data;
+	vector<string> names(modelMeshes.size());
+	for(int i=0; i<(int)modelMeshes.size(); i++){
+		names[i] = modelMeshes[i].name;
 	}
 	return names;
 }
 
 //-------------------------------------------
 int ofxAssimpModelLoader::getNumMeshes(){
-	return scene->mNumMeshes;
+	return modelMeshes.size();
 }
 
 //-------------------------------------------
 ofMesh ofxAssimpModelLoader::getMesh(string name){
+	if(!scene){
+		for(int i=0; i<(int)modelMeshes.size(); i++){
+			if(modelMeshes[i].name==name){
+				return modelMeshes[i].cachedMesh;
+			}
+		}
+	}
+
 	ofMesh ofm;
 	// default to triangle mode
 	ofm.setMode(OF_PRIMITIVE_TRIANGLES);
 	aiMesh * aim = NULL;
-	for(int i=0; i<(int)scene->mNumMeshes; i++){
+	for(int i=0; scene && i<(int)scene->mNumMeshes; i++){
 		if(string(scene->mMeshes[i]->mName.data)==name){
 			aim = scene->mMeshes[i];
 			break;
@@ -798,57 +1513,136 @@ ofMesh ofxAssimpModelLoader::getMesh(string name){
 //-------------------------------------------
 ofMesh ofxAssimpModelLoader::getMesh(int num){
 	ofMesh ofm;
-	if((int)scene->mNumMeshes<=num){
+	if((int)modelMeshes.size()<=num){
 		ofLogError("ofxAssimpModelLoader") << "getMesh(): mesh id " << num
-		<< " out of range for total num meshes: " << scene->mNumMeshes;
+		<< " out of range for total num meshes: " << modelMeshes.size();
 		return ofm;
 	}
+	if(!scene){
+		// cached models are static, so the cached mesh is the source mesh.
+		return modelMeshes[num].cachedMesh;
+	}
 
 	aiMeshToOfMesh(scene->mMeshes[num],ofm);
 	return ofm;
 }
 
 //-------------------------------------------
-ofMesh ofxAssimpModelLoader::getCurrentAnimatedMesh(string name){
+int ofxAssimpModelLoader::getMeshIndex(string name){
 	for(int i=0; i<(int)modelMeshes.size(); i++){
-		if(string(modelMeshes[i].mesh->mName.data)==name){
-			if(!modelMeshes[i].validCache){
-				modelMeshes[i].cachedMesh.clearVertices();
-				modelMeshes[i].cachedMesh.clearNormals();
-				modelMeshes[i].cachedMesh.addVertices(aiVecVecToOfVecVec(modelMeshes[i].animatedPos));
-				modelMeshes[i].cachedMesh.addNormals(aiVecVecToOfVecVec(modelMeshes[i].animatedNorm));
-				modelMeshes[i].validCache = true;
-			}
-			return modelMeshes[i].cachedMesh;
+		if(modelMeshes[i].name==name){
+			return i;
 		}
 	}
+	return -1;
+}
 
-	ofLogError("ofxAssimpModelLoader") << "getCurrentAnimatedMesh(): couldn't find mesh: \"" + name << "\"";
-	return ofMesh();
-
+//-------------------------------------------
+const ofMesh & ofxAssimpModelLoader::getCurrentAnimatedMesh(string name){
+	int num = getMeshIndex(name);
+	if(num < 0){
+		ofLogError("ofxAssimpModelLoader") << "getCurrentAnimatedMesh(): couldn't find mesh: \"" + name << "\"";
+		static ofMesh emptyMesh;
+		return emptyMesh;
+	}
+	return getCurrentAnimatedMesh(num);
 }
 
 //-------------------------------------------
-ofMesh ofxAssimpModelLoader::getCurrentAnimatedMesh(int num){
+const ofMesh & ofxAssimpModelLoader::getCurrentAnimatedMesh(int num){
 	if((int)modelMeshes.size()<=num){
 		ofLogError("ofxAssimpModelLoader") << "getCurrentAnimatedMesh(): mesh id: " << num
-			<< "out of range for total num meshes: " << scene->mNumMeshes;
-		return ofMesh();
+			<< "out of range for total num meshes: " << modelMeshes.size();
+		static ofMesh emptyMesh;
+		return emptyMesh;
+	}
+	ofxAssimpMeshHelper & meshHelper = modelMeshes[num];
+	if(!meshHelper.validCache){
+		// copy the skinned pose over the cached mesh's arrays, which are
+		// already the right size.
+		skinMesh(meshHelper);
+		vector<ofVec3f> & vertices = meshHelper.cachedMesh.getVertices();
+		vertices.resize(meshHelper.animatedPos.size());
+		if(!vertices.empty()){
+			memcpy(&vertices[0], &meshHelper.animatedPos[0], vertices.size() * sizeof(ofVec3f));
+		}
+		if(!meshHelper.animatedNorm.empty()){
+			vector<ofVec3f> & normals = meshHelper.cachedMesh.getNormals();
+			normals.resize(meshHelper.animatedNorm.size());
+			memcpy(&normals[0], &meshHelper.animatedNorm[0], normals.size() * sizeof(ofVec3f));
+		}
+		meshHelper.validCache = true;
+	}
+	return meshHelper.cachedMesh;
+}
+
+//-------------------------------------------
+ofxAssimpMeshView ofxAssimpModelLoader::getMeshView(string name){
+	int num = getMeshIndex(name);
+	if(num < 0){
+		ofLogError("ofxAssimpModelLoader") << "getMeshView(): couldn't find mesh: \"" << name << "\"";
+		return ofxAssimpMeshView();
+	}
+	return getMeshView(num);
+}
+
+//-------------------------------------------
+ofxAssimpMeshView ofxAssimpModelLoader::getMeshView(int num){
+	ofxAssimpMeshView view;
+	if((int)modelMeshes.size()<=num){
+		ofLogError("ofxAssimpModelLoader") << "getMeshView(): mesh id " << num
+		<< " out of range for total num meshes: " << modelMeshes.size();
+		return view;
+	}
+	ofxAssimpMeshHelper & meshHelper = modelMeshes[num];
+	const aiMesh * mesh = meshHelper.mesh;
+	if(mesh){
+		view.vertices = ofxAssimpSpan<ofVec3f>((const ofVec3f *)mesh->mVertices, mesh->mNumVertices);
+		if(mesh->HasNormals()){
+			view.normals = ofxAssimpSpan<ofVec3f>((const ofVec3f *)mesh->mNormals, mesh->mNumVertices);
+		}
+	}else{
+		// cached models are static, so the cached mesh is the source mesh.
+		ofMesh & cachedMesh = meshHelper.cachedMesh;
+		view.vertices = ofxAssimpSpan<ofVec3f>(cachedMesh.getVerticesPointer(), cachedMesh.getNumVertices());
+		view.normals = ofxAssimpSpan<ofVec3f>(cachedMesh.getNormalsPointer(), cachedMesh.getNumNormals());
+	}
+	view.indices = ofxAssimpSpan<ofIndexType>(meshHelper.indices.empty() ? NULL : &meshHelper.indices[0], meshHelper.indices.size());
+	return view;
+}
+
+//-------------------------------------------
+ofxAssimpMeshView ofxAssimpModelLoader::getCurrentAnimatedMeshView(string name){
+	int num = getMeshIndex(name);
+	if(num < 0){
+		ofLogError("ofxAssimpModelLoader") << "getCurrentAnimatedMeshView(): couldn't find mesh: \"" << name << "\"";
+		return ofxAssimpMeshView();
+	}
+	return getCurrentAnimatedMeshView(num);
+}
+
+//-------------------------------------------
+ofxAssimpMeshView ofxAssimpModelLoader::getCurrentAnimatedMeshView(int num){
+	ofxAssimpMeshView view = getMeshView(num);
+	if(view.vertices.empty()){
+		return view;
 	}
-	if(!modelMeshes[num].validCache){
-		modelMeshes[num].cachedMesh.clearVertices();
-		modelMeshes[num].cachedMesh.clearNormals();
-		modelMeshes[num].cachedMesh.addVertices(aiVecVecToOfVecVec(modelMeshes[num].animatedPos));
-		modelMeshes[num].cachedMesh.addNormals(aiVecVecToOfVecVec(modelMeshes[num].animatedNorm));
-		modelMeshes[num].validCache = true;
+	// meshes without bones don't deform; their bind pose is the current pose.
+	ofxAssimpMeshHelper & meshHelper = modelMeshes[num];
+	if(meshHelper.mesh && meshHelper.mesh->mNumBones){
+		skinMesh(meshHelper);
+		view.vertices = ofxAssimpSpan<ofVec3f>((const ofVec3f *)&meshHelper.animatedPos[0], meshHelper.animatedPos.size());
+		if(!meshHelper.animatedNorm.empty()){
+			view.normals = ofxAssimpSpan<ofVec3f>((const ofVec3f *)&meshHelper.animatedNorm[0], meshHelper.animatedNorm.size());
+		}
 	}
-	return modelMeshes[num].cachedMesh;
+	return view;
 }
 
 //-------------------------------------------
 ofMaterial ofxAssimpModelLoader::getMaterialForMesh(string name){
 	for(int i=0; i<(int)modelMeshes.size(); i++){
-		if(string(modelMeshes[i].mesh->mName.data)==name){
+		if(modelMeshes[i].name==name){
 			return modelMeshes[i].material;
 		}
 	}
@@ -860,7 +1654,7 @@ ofMaterial ofxAssimpModelLoader::getMaterialForMesh(string name){
 ofMaterial ofxAssimpModelLoader::getMaterialForMesh(int num){
 	if((int)modelMeshes.size()<=num){
 		ofLogError("ofxAssimpModelLoader") << "getMaterialForMesh(): mesh id: " << num
-			<< "out of range for total num meshes: " << scene->mNumMeshes;
+			<< "out of range for total num meshes: " << modelMeshes.size();
 		return ofMaterial();
 	}
 	return modelMeshes[num].material;
@@ -869,7 +1663,7 @@ ofMaterial ofxAssimpModelLoader::getMaterialForMesh(int num){
 //-------------------------------------------
 ofTexture ofxAssimpModelLoader::getTextureForMesh(string name){
 	for(int i=0; i<(int)modelMeshes.size(); i++){
-		if(string(modelMeshes[i].mesh->mName.data)==name){
+		if(modelMeshes[i].name==name){
             if(modelMeshes[i].hasTexture()) {
                 return modelMeshes[i].getTextureRef();
             }
@@ -887,7 +1681,7 @@ ofTexture ofxAssimpModelLoader::getTextureForMesh(int i){
         }
 	}
     ofLogError("ofxAssimpModelLoader") << "getTextureForMesh(): mesh id: " << i
-			<< "out of range for total num meshes: " << scene->mNumMeshes;
+			<< "out of range for total num meshes: " << modelMeshes.size();
     return ofTexture();
 }
 
@@ -964,6 +1758,56 @@ const aiScene* ofxAssimpModelLoader::getAssimpScene(){
 	return scene.get();
 }
 
+//--------------------------------------------------------------
+void ofxAssimpModelLoader::enableMeshCache(){
+	bUsingMeshCache = true;
+}
+
+//--------------------------------------------------------------
+void ofxAssimpModelLoader::disableMeshCache(){
+	bUsingMeshCache = false;
+}
+
+//--------------------------------------------------------------
+bool ofxAssimpModelLoader::isLoadedFromMeshCache(){
+	return bLoadedFromCache;
+}
+
+//--------------------------------------------------------------
+bool ofxAssimpModelLoader::enableGPUSkinning(string vertShader, string fragShader){
+	if(!ofIsGLProgrammableRenderer()){
+		ofLogWarning("ofxAssimpModelLoader") << "enableGPUSkinning(): needs the programmable renderer, skinning on the CPU";
+		return false;
+	}
+	if(!skinningShader.isLoaded()){
+		skinningShader.setupShaderFromFile(GL_VERTEX_SHADER, vertShader);
+		skinningShader.setupShaderFromFile(GL_FRAGMENT_SHADER, fragShader);
+		skinningShader.bindDefaults();
+		skinningShader.bindAttribute(OFX_ASSIMP_BONE_INDEX_ATTRIBUTE, "boneIndices");
+		skinningShader.bindAttribute(OFX_ASSIMP_BONE_WEIGHT_ATTRIBUTE, "boneWeights");
+		if(!skinningShader.linkProgram()){
+			ofLogError("ofxAssimpModelLoader") << "enableGPUSkinning(): couldn't load skinning shader, skinning on the CPU";
+			return false;
+		}
+	}
+	bUsingGPUSkinning = true;
+	uploadSkinningAttributes();
+	return bUsingGPUSkinning;
+}
+
+//--------------------------------------------------------------
+void ofxAssimpModelLoader::disableGPUSkinning(){
+	bUsingGPUSkinning = false;
+	for(unsigned int i=0; i<modelMeshes.size(); i++){
+		modelMeshes[i].validSkin = false;
+	}
+}
+
+//--------------------------------------------------------------
+bool ofxAssimpModelLoader::isUsingGPUSkinning(){
+	return bUsingGPUSkinning;
+}
+
 //--------------------------------------------------------------
 void ofxAssimpModelLoader::enableTextures(){
 	bUsingTextures = true;
@@ -18,10 +18,47 @@
 #include "ofxAssimpMeshHelper.h"
 #include "ofxAssimpAnimation.h"
 #include "ofxAssimpTexture.h"
+#include "ofxAssimpMeshCache.h"
+#include "ofxAssimpImportThread.h"
+#include "ofxAssimpRenderQueue.h"
+#include "ofxAssimpMeshView.h"
 
 class aiScene;
 class aiNode;
 
+// must match MAX_BONES in skinning.vert.
+#define OFX_ASSIMP_MAX_GPU_BONES 64
+
+// vertex attribute locations for GPU skinning, after OF's default ones.
+#define OFX_ASSIMP_BONE_INDEX_ATTRIBUTE 4
+#define OFX_ASSIMP_BONE_WEIGHT_ATTRIBUTE 5
+
+enum ofxAssimpLoadState {
+    OFX_ASSIMP_LOAD_IDLE,
+    OFX_ASSIMP_LOAD_IMPORTING,  // reading and post-processing on the worker thread
+    OFX_ASSIMP_LOAD_UPLOADING,  // uploading buffers and textures a slice per step
+    OFX_ASSIMP_LOAD_DONE,
+    OFX_ASSIMP_LOAD_FAILED
+};
+
+// a texture decoded on the import thread, waiting to be uploaded.
+struct ofxAssimpPendingImage {
+    string path;
+    ofPixels pixels;
+    ofTexture texture;
+};
+
+// a GL buffer of a mesh being uploaded, and the data that goes in it.
+struct ofxAssimpUploadBuffer {
+    GLenum target;
+    GLuint id;
+    const char * data;
+    size_t size;
+
+    // texture coordinates still to be converted for the mesh's texture.
+    bool bTexCoords;
+};
+
 class ofxAssimpModelLoader{
 
     public:
@@ -30,6 +67,23 @@ class ofxAssimpModelLoader{
 
         bool loadModel(string modelName, bool optimize=false);
         bool loadModel(ofBuffer & buffer, bool optimize=false, const char * extension="");
+
+        // Loads a model without blocking. The file is read, imported, converted
+        // and its textures decoded on a worker thread; update() then uploads
+        // buffers and textures in slices, spending at most the upload budget
+        // per frame. The current model keeps drawing
+        // until the new one is complete and swaps in at the end of an update().
+        // A request made while another import is running waits for it
+        // without blocking, replacing any older waiting request, and the
+        // earlier result is dropped. Returns false if the file doesn't exist.
+        bool loadModelAsync(string modelName, bool optimize=false);
+        ofxAssimpLoadState getLoadState();
+        bool isLoading();
+
+        // GL upload time per update() for async loads, in milliseconds. At
+        // least one slice of at most 256 KB is uploaded per update()
+        // regardless.
+        void setUploadBudget(float milliseconds);
         void createEmptyModel();
         void createLightsFromAiModel();
         void optimizeScene();
@@ -70,8 +124,17 @@ class ofxAssimpModelLoader{
         ofMesh getMesh(string name);
         ofMesh getMesh(int num);
 
-        ofMesh getCurrentAnimatedMesh(string name);
-        ofMesh getCurrentAnimatedMesh(int num);
+        // the returned mesh is owned by the loader and refreshed in place.
+        const ofMesh & getCurrentAnimatedMesh(string name);
+        const ofMesh & getCurrentAnimatedMesh(int num);
+
+        // Views over the loader's own vertex data, without copying. Bind pose
+        // views stay valid until the model is cleared; animated views until
+        // the next update().
+        ofxAssimpMeshView getMeshView(string name);
+        ofxAssimpMeshView getMeshView(int num);
+        ofxAssimpMeshView getCurrentAnimatedMeshView(string name);
+        ofxAssimpMeshView getCurrentAnimatedMeshView(int num);
 
         ofMaterial getMaterialForMesh(string name);
         ofMaterial getMaterialForMesh(int num);
@@ -84,6 +147,21 @@ class ofxAssimpModelLoader{
     	void drawFaces();
     	void drawVertices();
 
+    	// keep a binary cache of static models next to the model file, so
+    	// later loads of the same file skip Assimp. off by default.
+    	void enableMeshCache();
+    	void disableMeshCache();
+    	bool isLoadedFromMeshCache();
+
+    	// skin animated meshes in a vertex shader instead of on the CPU. bind
+    	// pose vertices, bone indices and weights are uploaded once and only
+    	// the bone palette is sent per frame. needs the programmable renderer;
+    	// falls back to CPU skinning if the shader can't be loaded or a mesh
+    	// has more than OFX_ASSIMP_MAX_GPU_BONES bones.
+    	bool enableGPUSkinning(string vertShader="skinning.vert", string fragShader="skinning.frag");
+    	void disableGPUSkinning();
+    	bool isUsingGPUSkinning();
+
     	void enableTextures();
     	void disableTextures();
     	void enableNormals();
@@ -110,6 +188,7 @@ class ofxAssimpModelLoader{
 
         void calculateDimensions();
 
+		// NULL if the model was loaded from a mesh cache.
 		const aiScene * getAssimpScene();
          
     protected:
@@ -118,10 +197,35 @@ class ofxAssimpModelLoader{
         void updateAnimations();
         void updateMeshes(aiNode * node, ofMatrix4x4 parentMatrix);
         void updateBones();
+        void updateBonePalette(ofxAssimpMeshHelper & meshHelper);
+        void skinMesh(ofxAssimpMeshHelper & meshHelper);
+        int getMeshIndex(string name);
+        void uploadSkinningAttributes();
+    
+        // flattens the node hierarchy and builds per mesh skinning tables.
+        void buildSkeleton();
         void updateModelMatrix();
 
         // Initial VBO creation, etc
         void loadGLResources();
+        void loadMeshGLResources(const aiScene * sourceScene, unsigned int meshIndex,
+                                 ofxAssimpMeshHelper & meshHelper,
+                                 vector<ofxAssimpTexture> & textures, string modelFolder);
+
+        // Fills in everything of a mesh helper except its VBO and texture.
+        // No GL, so safe on the import thread. Texture coordinates are only
+        // converted for the mesh's texture if it's already set.
+        void loadMeshData(const aiScene * sourceScene, unsigned int meshIndex,
+                          ofxAssimpMeshHelper & meshHelper);
+        string getMeshTexturePath(const aiScene * sourceScene, unsigned int meshIndex, string modelFolder);
+        int getMeshUsage(const aiScene * sourceScene);
+        void loadMeshTexture(ofxAssimpMeshHelper & meshHelper, string realPath, vector<ofxAssimpTexture> & textures);
+    
+        // Import flags for a loadModel() call.
+        unsigned int getImportFlags(bool optimize);
+    
+        // Loads meshes, materials and textures from a mesh cache instead of Assimp.
+        bool loadModelFromCache(string cachePath, const ofxAssimpMeshCacheSource & source, unsigned int flags);
     
         // Updates the internal animation transforms for the selected animation index
         void updateAnimation(unsigned int animationIndex, float time);
@@ -129,8 +233,31 @@ class ofxAssimpModelLoader{
         // updates the *actual GL resources* for the current animation
         void updateGLResources();
     
-        void getBoundingBoxWithMinVector(struct aiVector3D* min, struct aiVector3D* max);
-        void getBoundingBoxForNode(const struct aiNode* nd,  struct aiVector3D* min, struct aiVector3D* max, struct aiMatrix4x4* trafo);
+        // Center and normalized scale from scene_min / scene_max.
+        void calculateScale();
+    
+        void getBoundingBoxWithMinVector(const aiScene * sourceScene, struct aiVector3D* min, struct aiVector3D* max);
+        void getBoundingBoxForNode(const aiScene * sourceScene, const struct aiNode* nd,  struct aiVector3D* min, struct aiVector3D* max, struct aiMatrix4x4* trafo);
+    
+        // Async loading. importPendingModel() runs on the import thread;
+        // startQueuedLoad() and uploadPendingModel() run in update() on the
+        // GL thread.
+        friend class ofxAssimpImportThread;
+        void startQueuedLoad();
+        void importPendingModel();
+        void uploadPendingModel();
+
+        // Uploads the next slice of the pending model. Returns false once
+        // everything is uploaded.
+        bool uploadPendingSlice();
+
+        // Creates a pending mesh's buffers without filling them, and queues
+        // their data in pendingBuffers.
+        void beginMeshUpload(ofxAssimpMeshHelper & meshHelper);
+        void setLoadState(ofxAssimpLoadState state);
+
+        // the state as the import thread sees it, ignoring a waiting request.
+        ofxAssimpLoadState getImportState();
 
         ofFile file;
 
@@ -149,14 +276,61 @@ class ofxAssimpModelLoader{
         vector<ofxAssimpTexture> textures;
         vector<ofxAssimpMeshHelper> modelMeshes;
         vector<ofxAssimpAnimation> animations;
+
+        // scratch space for sampling the playing animations together.
+        vector<ofxAssimpAnimationJob> animationJobs;
+        vector<unsigned int> sampledAnimations;
+
+        // draw order of modelMeshes, rebuilt lazily after a load.
+        ofxAssimpRenderQueue renderQueue;
+
+        // scene nodes with parents before children, and their global
+        // transforms for the current pose.
+        vector<const aiNode *> skeletonNodes;
+        vector<int> skeletonParents;
+        vector<aiMatrix4x4> skeletonTransforms;
         int currentAnimation; // DEPRECATED - to be removed with deprecated animation functions.
 
         bool bUsingTextures;
         bool bUsingNormals;
         bool bUsingColors;
         bool bUsingMaterials;
+        bool bUsingMeshCache;
+        bool bUsingGPUSkinning;
+        ofShader skinningShader;
+        bool bLoadedFromCache;
         float normalizeFactor;
 
         // the main Asset Import scene that does the magic.
         shared_ptr<const aiScene> scene;
+
+        // the newest loadModelAsync() request, waiting for the import thread
+        // to be free. only touched on the GL thread.
+        bool bQueuedLoad;
+        ofFile queuedFile;
+        unsigned int queuedFlags;
+
+        // the model being loaded by loadModelAsync(). only the import thread
+        // touches it while the state is OFX_ASSIMP_LOAD_IMPORTING, and the
+        // state itself is guarded by the thread's lock.
+        shared_ptr<ofxAssimpImportThread> importThread;
+        ofxAssimpLoadState loadState;
+        ofFile pendingFile;
+        unsigned int pendingFlags;
+        shared_ptr<const aiScene> pendingScene;
+        aiVector3D pendingMin, pendingMax;
+        vector<ofxAssimpMeshHelper> pendingMeshes;
+        vector<string> pendingMeshTextures;
+        vector<ofxAssimpPendingImage> pendingImages;
+        vector<ofxAssimpTexture> pendingTextures;
+
+        // upload progress: the image or mesh being uploaded, the buffers of
+        // that mesh, and the row or byte offset into the current image or
+        // buffer.
+        unsigned int pendingImageIndex;
+        unsigned int pendingMeshIndex;
+        vector<ofxAssimpUploadBuffer> pendingBuffers;
+        unsigned int pendingBufferIndex;
+        size_t pendingOffset;
+        float uploadBudget;
 };
@@ -0,0 +1,190 @@
+//
+//  ofxAssimpRenderQueue.cpp
+//
+
+#include "ofxAssimpRenderQueue.h"
+
+#include <algorithm>
+#include <limits>
+
+//--------------------------------------------------------------
+bool ofxAssimpSortKey::operator<(const ofxAssimpSortKey & other) const {
+    if(skinned != other.skinned) return skinned < other.skinned;
+    if(material != other.material) return material < other.material;
+    if(texture != other.texture) return texture < other.texture;
+    if(blendMode != other.blendMode) return blendMode < other.blendMode;
+    return twoSided < other.twoSided;
+}
+
+bool ofxAssimpSortKey::operator==(const ofxAssimpSortKey & other) const {
+    return skinned == other.skinned && material == other.material && texture == other.texture &&
+        blendMode == other.blendMode && twoSided == other.twoSided;
+}
+
+//--------------------------------------------------------------
+static bool colorsEqual(const ofFloatColor & a, const ofFloatColor & b){
+    return a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a;
+}
+
+//--------------------------------------------------------------
+static bool sameLayout(ofMesh & a, ofMesh & b){
+    return a.hasNormals() == b.hasNormals() && a.hasColors() == b.hasColors() &&
+        a.hasTexCoords() == b.hasTexCoords();
+}
+
+//--------------------------------------------------------------
+struct ofxAssimpSortEntry {
+    ofxAssimpSortKey key;
+    int meshIndex;
+
+    bool blended() const {
+        return key.blendMode != OF_BLENDMODE_DISABLED;
+    }
+
+    // opaque meshes first, sorted by state. blended meshes composite in
+    // draw order, so they follow in scene order and only adjacent ones
+    // with equal keys end up sharing a batch.
+    bool operator<(const ofxAssimpSortEntry & other) const {
+        if(blended() != other.blended()) return !blended();
+        if(blended() || key == other.key) return meshIndex < other.meshIndex;
+        return key < other.key;
+    }
+};
+
+//--------------------------------------------------------------
+ofxAssimpRenderQueue::ofxAssimpRenderQueue(){
+    bBuilt = false;
+}
+
+//--------------------------------------------------------------
+void ofxAssimpRenderQueue::build(vector<ofxAssimpMeshHelper> & meshes, bool bMergeStatic){
+    clear();
+
+    vector<ofxAssimpSortEntry> entries(meshes.size());
+    for(unsigned int i = 0; i < meshes.size(); i++){
+        ofxAssimpMeshHelper & mesh = meshes[i];
+        ofxAssimpSortKey & key = entries[i].key;
+        key.skinned = !mesh.boneNodes.empty();
+        key.material = findMaterial(mesh.material);
+        key.texture = mesh.hasTexture() ? mesh.getTextureRef().getTextureData().textureID : 0;
+        key.blendMode = mesh.blendMode;
+        key.twoSided = mesh.twoSided;
+        entries[i].meshIndex = i;
+    }
+    std::sort(entries.begin(), entries.end());
+
+    for(unsigned int i = 0; i < entries.size(); i++){
+        int meshIndex = entries[i].meshIndex;
+        bool bJoin = bMergeStatic && !batches.empty() && batches.back().key == entries[i].key &&
+            sameLayout(meshes[batches.back().meshIndex].cachedMesh, meshes[meshIndex].cachedMesh);
+
+        // merged indices have to fit the index type, which is 16 bit on GLES.
+        if(bJoin){
+            size_t numVertices = meshes[meshIndex].cachedMesh.getNumVertices();
+            vector<int> & joined = batches.back().meshIndices;
+            for(unsigned int j = 0; j < joined.size(); j++){
+                numVertices += meshes[joined[j]].cachedMesh.getNumVertices();
+            }
+            bJoin = numVertices <= std::numeric_limits<ofIndexType>::max();
+        }
+
+        if(bJoin){
+            batches.back().meshIndices.push_back(meshIndex);
+            continue;
+        }
+        batches.push_back(ofxAssimpDrawBatch());
+        ofxAssimpDrawBatch & batch = batches.back();
+        batch.key = entries[i].key;
+        batch.meshIndex = meshIndex;
+        batch.meshIndices.push_back(meshIndex);
+        batch.merged = false;
+        batch.numIndices = meshes[meshIndex].indices.size();
+    }
+
+    for(unsigned int i = 0; i < batches.size(); i++){
+        if(batches[i].meshIndices.size() > 1){
+            merge(batches[i], meshes);
+        }
+    }
+
+    ofLogVerbose("ofxAssimpRenderQueue") << "build(): " << meshes.size() << " meshes in "
+        << batches.size() << " batches, " << materials.size() << " materials";
+    bBuilt = true;
+}
+
+//--------------------------------------------------------------
+void ofxAssimpRenderQueue::merge(ofxAssimpDrawBatch & batch, vector<ofxAssimpMeshHelper> & meshes){
+    vector<ofVec3f> vertices;
+    vector<ofVec3f> normals;
+    vector<ofFloatColor> colors;
+    vector<ofVec2f> texCoords;
+    vector<ofIndexType> indices;
+
+    // bake each mesh's node matrix into its vertices.
+    for(unsigned int i = 0; i < batch.meshIndices.size(); i++){
+        ofxAssimpMeshHelper & helper = meshes[batch.meshIndices[i]];
+        ofMesh & mesh = helper.cachedMesh;
+        ofIndexType base = vertices.size();
+
+        for(int v = 0; v < mesh.getNumVertices(); v++){
+            vertices.push_back(mesh.getVertex(v) * helper.matrix);
+        }
+        for(int n = 0; n < mesh.getNumNormals(); n++){
+            normals.push_back(ofMatrix4x4::transform3x3(mesh.getNormal(n), helper.matrix).getNormalized());
+        }
+        colors.insert(colors.end(), mesh.getColors().begin(), mesh.getColors().end());
+        texCoords.insert(texCoords.end(), mesh.getTexCoords().begin(), mesh.getTexCoords().end());
+        for(unsigned int j = 0; j < helper.indices.size(); j++){
+            indices.push_back(base + helper.indices[j]);
+        }
+    }
+
+    batch.vbo.setVertexData(&vertices[0], vertices.size(), GL_STATIC_DRAW);
+    if(!normals.empty()){
+        batch.vbo.setNormalData(&normals[0], normals.size(), GL_STATIC_DRAW);
+    }
+    if(!colors.empty()){
+        batch.vbo.setColorData(&colors[0], colors.size(), GL_STATIC_DRAW);
+    }
+    if(!texCoords.empty()){
+        batch.vbo.setTexCoordData(&texCoords[0], texCoords.size(), GL_STATIC_DRAW);
+    }
+    if(!indices.empty()){
+        batch.vbo.setIndexData(&indices[0], indices.size(), GL_STATIC_DRAW);
+    }
+    batch.numIndices = indices.size();
+    batch.merged = true;
+}
+
+//--------------------------------------------------------------
+int ofxAssimpRenderQueue::findMaterial(ofMaterial & material){
+    for(unsigned int i = 0; i < materials.size(); i++){
+        ofMaterial & other = materials[i];
+        if(colorsEqual(other.getDiffuseColor(), material.getDiffuseColor()) &&
+           colorsEqual(other.getSpecularColor(), material.getSpecularColor()) &&
+           colorsEqual(other.getAmbientColor(), material.getAmbientColor()) &&
+           colorsEqual(other.getEmissiveColor(), material.getEmissiveColor()) &&
+           other.getShininess() == material.getShininess()){
+            return i;
+        }
+    }
+    materials.push_back(material);
+    return materials.size() - 1;
+}
+
+//--------------------------------------------------------------
+void ofxAssimpRenderQueue::clear(){
+    materials.clear();
+    batches.clear();
+    bBuilt = false;
+}
+
+//--------------------------------------------------------------
+bool ofxAssimpRenderQueue::isBuilt(){
+    return bBuilt;
+}
+
+//--------------------------------------------------------------
+vector<ofxAssimpDrawBatch> & ofxAssimpRenderQueue::getBatches(){
+    return batches;
+}
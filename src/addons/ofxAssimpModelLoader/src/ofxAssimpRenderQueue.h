@@ -0,0 +1,64 @@
+//
+//  ofxAssimpRenderQueue.h
+//
+//  Draw order for ofxAssimpModelLoader. Meshes are sorted by the state they
+//  need (skinning, material, texture, blend mode, culling) so the loader
+//  only changes state between batches that differ, and static meshes that
+//  share state are pre-transformed and merged into one VBO. Only opaque
+//  meshes are reordered; blended ones are drawn after them in scene order.
+//
+
+#pragma once
+
+#include "ofMain.h"
+#include "ofxAssimpMeshHelper.h"
+
+struct ofxAssimpSortKey {
+    bool skinned;
+    int material;       // index into the queue's list of distinct materials
+    GLuint texture;     // 0 if untextured
+    ofBlendMode blendMode;
+    bool twoSided;
+
+    bool operator<(const ofxAssimpSortKey & other) const;
+    bool operator==(const ofxAssimpSortKey & other) const;
+};
+
+struct ofxAssimpDrawBatch {
+    ofxAssimpSortKey key;
+
+    // mesh whose material, texture and matrix the batch is drawn with.
+    int meshIndex;
+    vector<int> meshIndices;
+
+    // merged batches draw their own VBO with vertices already in model
+    // space; others draw meshIndex's VBO under its node matrix.
+    bool merged;
+    ofVbo vbo;
+    int numIndices;
+};
+
+class ofxAssimpRenderQueue {
+
+public:
+
+    ofxAssimpRenderQueue();
+
+    // sorts |meshes| into batches. if |bMergeStatic|, runs of meshes with
+    // equal keys and vertex layouts are merged, which is only valid while
+    // their matrices and vertices don't change (no animations).
+    void build(vector<ofxAssimpMeshHelper> & meshes, bool bMergeStatic);
+    void clear();
+    bool isBuilt();
+
+    vector<ofxAssimpDrawBatch> & getBatches();
+
+private:
+
+    int findMaterial(ofMaterial & material);
+    void merge(ofxAssimpDrawBatch & batch, vector<ofxAssimpMeshHelper> & meshes);
+
+    bool bBuilt;
+    vector<ofMaterial> materials;
+    vector<ofxAssimpDrawBatch> batches;
+};
@@ -0,0 +1,106 @@
+//
+//  ofxAssimpWireframe.cpp
+//
+
+#include "ofxAssimpWireframe.h"
+
+#include <algorithm>
+#include <map>
+
+//--------------------------------------------------------------
+struct ofxAssimpWireframePosition {
+    float x, y, z;
+
+    bool operator<(const ofxAssimpWireframePosition & other) const {
+        if(x != other.x) return x < other.x;
+        if(y != other.y) return y < other.y;
+        return z < other.z;
+    }
+};
+
+//--------------------------------------------------------------
+struct ofxAssimpWireframeEdge {
+    ofIndexType a, b;   // welded indices, a < b
+    unsigned int face;
+
+    bool operator<(const ofxAssimpWireframeEdge & other) const {
+        if(a != other.a) return a < other.a;
+        return b < other.b;
+    }
+    bool sameEdge(const ofxAssimpWireframeEdge & other) const {
+        return a == other.a && b == other.b;
+    }
+};
+
+//--------------------------------------------------------------
+ofMesh ofxAssimpWireframe::build(const ofxAssimpMeshView & view, float creaseAngle){
+    ofMesh wireframe;
+    wireframe.setMode(OF_PRIMITIVE_LINES);
+
+    // weld.
+    vector<ofIndexType> welded(view.vertices.size());
+    map<ofxAssimpWireframePosition, ofIndexType> positions;
+    for(size_t i = 0; i < view.vertices.size(); i++){
+        const ofVec3f & v = view.vertices[i];
+        ofxAssimpWireframePosition key = { v.x, v.y, v.z };
+        map<ofxAssimpWireframePosition, ofIndexType>::iterator it = positions.find(key);
+        if(it == positions.end()){
+            it = positions.insert(make_pair(key, (ofIndexType)wireframe.getNumVertices())).first;
+            wireframe.addVertex(v);
+        }
+        welded[i] = it->second;
+    }
+
+    // three edges per face; sorting puts the copies of each edge together.
+    size_t numFaces = view.getNumTriangles();
+    vector<ofxAssimpWireframeEdge> edges;
+    edges.reserve(numFaces * 3);
+    for(size_t f = 0; f < numFaces; f++){
+        for(int corner = 0; corner < 3; corner++){
+            ofIndexType a = welded[view.indices[3 * f + corner]];
+            ofIndexType b = welded[view.indices[3 * f + (corner + 1) % 3]];
+            if(a == b){
+                continue;
+            }
+            ofxAssimpWireframeEdge edge = { min(a, b), max(a, b), (unsigned int)f };
+            edges.push_back(edge);
+        }
+    }
+    sort(edges.begin(), edges.end());
+
+    vector<ofVec3f> faceNormals;
+    float minCos = cosf(ofDegToRad(creaseAngle));
+    if(creaseAngle > 0){
+        faceNormals.resize(numFaces);
+        for(size_t f = 0; f < numFaces; f++){
+            const ofVec3f & v0 = view.getTriangleVertex(f, 0);
+            faceNormals[f] = (view.getTriangleVertex(f, 1) - v0).getCrossed(view.getTriangleVertex(f, 2) - v0).getNormalized();
+        }
+    }
+
+    vector<ofIndexType> & indices = wireframe.getIndices();
+    for(size_t i = 0; i < edges.size(); ){
+        size_t count = 1;
+        while(i + count < edges.size() && edges[i].sameEdge(edges[i + count])){
+            count++;
+        }
+
+        // only a manifold edge between two faces can be smooth.
+        bool keep = true;
+        if(creaseAngle > 0 && count == 2){
+            const ofVec3f & n0 = faceNormals[edges[i].face];
+            const ofVec3f & n1 = faceNormals[edges[i + 1].face];
+            bool degenerate = n0.lengthSquared() == 0 || n1.lengthSquared() == 0;
+            keep = degenerate || n0.dot(n1) < minCos;
+        }
+        if(keep){
+            indices.push_back(edges[i].a);
+            indices.push_back(edges[i].b);
+        }
+        i += count;
+    }
+
+    ofLogVerbose("ofxAssimpWireframe") << "build(): " << numFaces << " faces, "
+        << wireframe.getNumVertices() << " vertices, " << indices.size() / 2 << " edges";
+    return wireframe;
+}
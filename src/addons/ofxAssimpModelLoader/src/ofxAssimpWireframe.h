@@ -0,0 +1,25 @@
+//
+//  ofxAssimpWireframe.h
+//
+//  Builds indexed line meshes from triangle meshes. Each edge is emitted
+//  once, however many triangles share it.
+//
+
+#pragma once
+
+#include "ofMain.h"
+#include "ofxAssimpMeshView.h"
+
+class ofxAssimpWireframe {
+
+public:
+
+    // Returns an OF_PRIMITIVE_LINES mesh with two indices per edge of
+    // |view|. Vertices at the same position are welded first, since
+    // importers split them per face for normals and tex coords.
+    //
+    // With |creaseAngle| (degrees) above 0, only feature edges are kept:
+    // boundary edges and edges whose two faces meet at more than
+    // |creaseAngle|, which drops the diagonals of flat quads.
+    static ofMesh build(const ofxAssimpMeshView & view, float creaseAngle = 0);
+};
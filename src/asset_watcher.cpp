@@ -0,0 +1,273 @@
+#include "asset_watcher.h"
+
+#include <sys/stat.h>
+
+#ifdef TARGET_LINUX
+#include <poll.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#endif
+
+/* How long a file must be left alone after a write before it is reloaded,
+ * in milliseconds. */
+static const unsigned long long kSettleTime = 200;
+
+/* Modification time polling interval where inotify isn't available. */
+static const unsigned long long kPollInterval = 250;
+
+static time_t GetModificationTime(const std::string& path)
+{
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0) {
+        return 0;
+    }
+    return info.st_mtime;
+}
+
+AssetWatcher::AssetWatcher()
+{
+}
+
+AssetWatcher::~AssetWatcher()
+{
+    Stop();
+    for (size_t i = 0; i < models.size(); i++) {
+        delete models[i].loading;
+        delete models[i].current;
+    }
+}
+
+void AssetWatcher::WatchShader(ofShader* shader, const std::string& vertexPath,
+                               const std::string& fragmentPath)
+{
+    WatchedShader watched;
+    watched.shader = shader;
+    watched.vertexPath = ofToDataPath(vertexPath, true);
+    watched.fragmentPath = ofToDataPath(fragmentPath, true);
+    shaders.push_back(watched);
+    files[watched.vertexPath] = GetModificationTime(watched.vertexPath);
+    files[watched.fragmentPath] = GetModificationTime(watched.fragmentPath);
+}
+
+void AssetWatcher::WatchModel(const std::string& path)
+{
+    WatchedModel watched;
+    watched.name = path;
+    watched.path = ofToDataPath(path, true);
+    models.push_back(watched);
+    files[watched.path] = GetModificationTime(watched.path);
+}
+
+void AssetWatcher::Start()
+{
+    if (!isThreadRunning()) {
+        startThread(true, false);
+    }
+}
+
+void AssetWatcher::Stop()
+{
+    if (isThreadRunning()) {
+        waitForThread(true);
+    }
+}
+
+void AssetWatcher::Update()
+{
+    // Shaders: compile the new sources into a fresh program and only
+    // replace the live one if it links.
+    for (size_t i = 0; i < shaders.size(); i++) {
+        WatchedShader& watched = shaders[i];
+        lock();
+        bool pending = watched.pending;
+        std::string vertexSource, fragmentSource;
+        if (pending) {
+            vertexSource.swap(watched.vertexSource);
+            fragmentSource.swap(watched.fragmentSource);
+            watched.pending = false;
+        }
+        unlock();
+        if (!pending) {
+            continue;
+        }
+
+        ofShader shader;
+        bool ok = shader.setupShaderFromSource(GL_VERTEX_SHADER, vertexSource) &&
+                  shader.setupShaderFromSource(GL_FRAGMENT_SHADER, fragmentSource);
+        if (ok) {
+            shader.bindDefaults();
+            ok = shader.linkProgram();
+        }
+        if (ok) {
+            *watched.shader = shader;
+            ofLogNotice("AssetWatcher") << "reloaded " << watched.vertexPath << ", " << watched.fragmentPath;
+        }
+        else {
+            ofLogError("AssetWatcher") << "couldn't compile " << watched.vertexPath << ", "
+                << watched.fragmentPath << "; keeping the previous version";
+        }
+    }
+
+    // Models: reimport on the loader's own thread, then swap once every
+    // mesh has been uploaded.
+    for (size_t i = 0; i < models.size(); i++) {
+        WatchedModel& watched = models[i];
+        watched.reloaded = false;
+
+        lock();
+        bool pending = watched.pending && watched.loading == NULL;
+        if (pending) {
+            watched.pending = false;
+        }
+        unlock();
+        if (pending) {
+            watched.loading = new ofxAssimpModelLoader();
+            watched.loading->loadModelAsync(watched.name);
+        }
+
+        if (watched.loading == NULL) {
+            continue;
+        }
+        watched.loading->update();
+        switch (watched.loading->getLoadState()) {
+            case OFX_ASSIMP_LOAD_DONE:
+                delete watched.current;
+                watched.current = watched.loading;
+                watched.loading = NULL;
+                watched.reloaded = true;
+                ofLogNotice("AssetWatcher") << "reloaded " << watched.path;
+                break;
+            case OFX_ASSIMP_LOAD_FAILED:
+                delete watched.loading;
+                watched.loading = NULL;
+                ofLogError("AssetWatcher") << "couldn't import " << watched.path
+                    << "; keeping the previous version";
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+ofxAssimpModelLoader* AssetWatcher::GetReloadedModel(const std::string& path)
+{
+    for (size_t i = 0; i < models.size(); i++) {
+        if (models[i].name == path) {
+            return models[i].reloaded ? models[i].current : NULL;
+        }
+    }
+    return NULL;
+}
+
+void AssetWatcher::threadedFunction()
+{
+#ifdef TARGET_LINUX
+    // Watch the directories rather than the files: editors often save by
+    // writing a new file and renaming it over the old one.
+    int fd = inotify_init1(IN_NONBLOCK);
+    std::map<int, std::string> directories;
+    if (fd >= 0) {
+        std::map<std::string, time_t>::iterator it;
+        for (it = files.begin(); it != files.end(); ++it) {
+            std::string directory = it->first.substr(0, it->first.rfind('/'));
+            int wd = inotify_add_watch(fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+            if (wd >= 0) {
+                directories[wd] = directory;
+            }
+        }
+    }
+    if (fd < 0 || directories.empty()) {
+        ofLogWarning("AssetWatcher") << "inotify unavailable, polling instead";
+        if (fd >= 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+
+    char events[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    while (fd >= 0 && isThreadRunning()) {
+        struct pollfd request = { fd, POLLIN, 0 };
+        if (poll(&request, 1, 100) > 0) {
+            ssize_t length;
+            while ((length = read(fd, events, sizeof(events))) > 0) {
+                for (char* p = events; p < events + length; ) {
+                    const struct inotify_event* event = (const struct inotify_event*)p;
+                    if (event->len > 0 && directories.count(event->wd)) {
+                        MarkChanged(directories[event->wd] + "/" + event->name);
+                    }
+                    p += sizeof(struct inotify_event) + event->len;
+                }
+            }
+        }
+        DispatchChanges();
+    }
+    if (fd >= 0) {
+        close(fd);
+        return;
+    }
+#endif
+
+    while (isThreadRunning()) {
+        PollModificationTimes();
+        DispatchChanges();
+        ofSleepMillis(kPollInterval);
+    }
+}
+
+void AssetWatcher::MarkChanged(const std::string& path)
+{
+    if (files.count(path)) {
+        changes[path] = ofGetElapsedTimeMillis();
+    }
+}
+
+void AssetWatcher::PollModificationTimes()
+{
+    std::map<std::string, time_t>::iterator it;
+    for (it = files.begin(); it != files.end(); ++it) {
+        time_t modified = GetModificationTime(it->first);
+        if (modified != 0 && modified != it->second) {
+            it->second = modified;
+            MarkChanged(it->first);
+        }
+    }
+}
+
+void AssetWatcher::DispatchChanges()
+{
+    unsigned long long now = ofGetElapsedTimeMillis();
+    std::map<std::string, unsigned long long>::iterator it = changes.begin();
+    while (it != changes.end()) {
+        if (now - it->second < kSettleTime) {
+            ++it;
+            continue;
+        }
+        const std::string& path = it->first;
+
+        // Shader sources are read here so the GL thread only compiles.
+        for (size_t i = 0; i < shaders.size(); i++) {
+            WatchedShader& watched = shaders[i];
+            if (watched.vertexPath != path && watched.fragmentPath != path) {
+                continue;
+            }
+            std::string vertexSource = ofBufferFromFile(watched.vertexPath).getText();
+            std::string fragmentSource = ofBufferFromFile(watched.fragmentPath).getText();
+            if (vertexSource.empty() || fragmentSource.empty()) {
+                continue;
+            }
+            lock();
+            watched.vertexSource.swap(vertexSource);
+            watched.fragmentSource.swap(fragmentSource);
+            watched.pending = true;
+            unlock();
+        }
+        for (size_t i = 0; i < models.size(); i++) {
+            if (models[i].path == path) {
+                lock();
+                models[i].pending = true;
+                unlock();
+            }
+        }
+        changes.erase(it++);
+    }
+}
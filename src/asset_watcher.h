@@ -0,0 +1,94 @@
+#ifndef ASSET_WATCHER_H
+#define ASSET_WATCHER_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "ofMain.h"
+#include "addons/ofxAssimpModelLoader/src/ofxAssimpModelLoader.h"
+
+/* Reloads shaders and models while the app runs, whenever their files
+ * change on disk. A background thread watches the files (inotify on
+ * Linux, modification times elsewhere), reads changed shader sources and
+ * kicks off model imports; Update() swaps the results in between frames.
+ * If a shader fails to compile or a model fails to import, the previous
+ * version stays in use. */
+class AssetWatcher : public ofThread
+{
+public:
+    AssetWatcher();
+    ~AssetWatcher();
+
+    /* Recompiles |shader| from |vertexPath| and |fragmentPath| (relative to
+     * the data folder) when either changes. |shader| must outlive the
+     * watcher. Call before Start(). */
+    void WatchShader(ofShader* shader, const std::string& vertexPath,
+                     const std::string& fragmentPath);
+
+    /* Reimports |path| (relative to the data folder) when it changes. See
+     * GetReloadedModel(). Call before Start(). */
+    void WatchModel(const std::string& path);
+
+    /* Starts watching. */
+    void Start();
+
+    /* Stops watching and waits for the watcher thread. */
+    void Stop();
+
+    /* Swaps in whatever finished reloading. Call once per frame from the
+     * GL thread, before anything uses the watched assets. */
+    void Update();
+
+    /* The model at |path| if it was reloaded by the last Update(), else
+     * NULL. The loader is owned by the watcher and stays valid until the
+     * model is reloaded again. */
+    ofxAssimpModelLoader* GetReloadedModel(const std::string& path);
+
+private:
+    struct WatchedShader {
+        ofShader* shader;
+        std::string vertexPath;
+        std::string fragmentPath;
+
+        /* Sources read by the watcher thread, waiting to be compiled.
+         * Guarded by the thread lock. */
+        bool pending = false;
+        std::string vertexSource;
+        std::string fragmentSource;
+    };
+
+    struct WatchedModel {
+        std::string name;
+        std::string path;
+
+        /* Set by the watcher thread. Guarded by the thread lock. */
+        bool pending = false;
+
+        /* Main thread only. */
+        ofxAssimpModelLoader* loading = NULL;
+        ofxAssimpModelLoader* current = NULL;
+        bool reloaded = false;
+    };
+
+    void threadedFunction();
+
+    /* Notes that |path| was written. Changes are acted on once a file has
+     * been quiet for a moment, since editors save in several steps. */
+    void MarkChanged(const std::string& path);
+    void DispatchChanges();
+
+    /* Compares modification times of every watched file. */
+    void PollModificationTimes();
+
+    std::vector<WatchedShader> shaders;
+    std::vector<WatchedModel> models;
+
+    /* Every watched file, and its last seen modification time. */
+    std::map<std::string, time_t> files;
+
+    /* Watcher thread only: last change time of files not yet dispatched. */
+    std::map<std::string, unsigned long long> changes;
+};
+
+#endif
@@ -0,0 +1,86 @@
+#include "audio_geometry.h"
+
+/* Shapes, as numbered in the shader. */
+enum {
+    kRing = 0,
+    kWaveform = 1
+};
+
+AudioGeometry::AudioGeometry()
+{
+}
+
+void AudioGeometry::Setup(int newBlockSize, int newNumBlocks)
+{
+    blockSize = newBlockSize;
+    numBlocks = newNumBlocks;
+    head = 0;
+
+    std::vector<float> silence(blockSize * (numBlocks + 1), 0.f);
+    blocks.allocate(blockSize, numBlocks + 1, GL_R32F, false);
+    blocks.loadData(&silence[0], blockSize, numBlocks + 1, GL_RED);
+    blocks.setTextureMinMagFilter(GL_NEAREST, GL_NEAREST);
+
+    std::vector<ofVec3f> placeholders(blockSize);
+    vertices.setVertexData(&placeholders[0], blockSize, GL_STATIC_DRAW);
+
+    shader.load("audio_geometry.vert", "audio_geometry.frag");
+    if (!shader.linkProgram()) {
+        std::cerr << "Shaders not set up correctly!" << std::endl;
+    }
+}
+
+int AudioGeometry::Push(const float* samples)
+{
+    head = (head + 1) % numBlocks;
+    Upload(head, samples);
+    return head;
+}
+
+int AudioGeometry::SetCurrent(const float* samples)
+{
+    Upload(numBlocks, samples);
+    return numBlocks;
+}
+
+void AudioGeometry::Upload(int block, const float* samples)
+{
+    glBindTexture(GL_TEXTURE_2D, blocks.getTextureData().textureID);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, block, blockSize, 1, GL_RED, GL_FLOAT, samples);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+int AudioGeometry::GetBlockSize()
+{
+    return blockSize;
+}
+
+void AudioGeometry::DrawRing(int block, float x, float y, float radius, float gain, float sweep)
+{
+    shader.begin();
+    shader.setUniform3f("circle", x, y, radius);
+    shader.setUniform1f("sweep", sweep);
+    shader.setUniform1f("gain", gain);
+    Draw(block, kRing);
+}
+
+void AudioGeometry::DrawWaveform(int block, float left, float right, float baseline, float gain)
+{
+    shader.begin();
+    shader.setUniform3f("line", left, right, baseline);
+    shader.setUniform1f("gain", gain);
+    Draw(block, kWaveform);
+}
+
+void AudioGeometry::Draw(int block, int mode)
+{
+    // Set after begin() so the shader picks up the current color.
+    ofFloatColor color = ofGetStyle().color;
+    shader.setUniform4f("color", color.r, color.g, color.b, color.a);
+    shader.setUniformTexture("samples", blocks, 0);
+    shader.setUniform1i("block", block);
+    shader.setUniform1i("shape", mode);
+    vertices.draw(mode == kRing ? GL_LINE_LOOP : GL_LINE_STRIP, 0, blockSize);
+    shader.end();
+}
@@ -0,0 +1,61 @@
+#ifndef AUDIO_GEOMETRY_H
+#define AUDIO_GEOMETRY_H
+
+#include <vector>
+
+#include "ofMain.h"
+
+/* Draws tunnel rings and waveforms straight from raw sample blocks.
+ *
+ * Blocks of samples are uploaded once, as rows of a float texture: a ring
+ * of blocks for geometry that outlives the frame, and one more row for
+ * the current frame's block. A vertex shader places one vertex per sample
+ * from gl_VertexID and the sample it fetches, so no geometry is built on
+ * the CPU. The layout matches PolarLayout (rings) and
+ * MakeWaveformPolyline() (waveforms), which remain the CPU reference. */
+class AudioGeometry
+{
+public:
+    AudioGeometry();
+
+    /* Keeps the last |numBlocks| pushed blocks of |blockSize| samples and
+     * loads the shader. Call from the GL thread. */
+    void Setup(int blockSize, int numBlocks);
+
+    /* Uploads a block of GetBlockSize() samples over the oldest one.
+     * Returns its id, valid until |numBlocks| more blocks are pushed. */
+    int Push(const float* samples);
+
+    /* Uploads a block that is only needed until the next call, without
+     * touching the ring. Returns its id. */
+    int SetCurrent(const float* samples);
+
+    int GetBlockSize();
+
+    /* Draws |block| as a closed ring of |radius| + |gain| * sample around
+     * (|x|, |y|), over |sweep| radians. */
+    void DrawRing(int block, float x, float y, float radius, float gain, float sweep);
+
+    /* Draws |block| as a line from |left| to |right|, |gain| * sample
+     * from |baseline|. */
+    void DrawWaveform(int block, float left, float right, float baseline, float gain);
+
+private:
+    void Draw(int block, int mode);
+    void Upload(int block, const float* samples);
+
+    int blockSize = 0;
+    int numBlocks = 0;
+    int head = 0;
+
+    /* One row per block, then the current block. */
+    ofTexture blocks;
+
+    /* Placeholder vertices to draw from; the shader only uses their
+     * index. */
+    ofVbo vertices;
+
+    ofShader shader;
+};
+
+#endif
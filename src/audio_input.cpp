@@ -1,44 +1,70 @@
 #include "audio_input.h"
 
+#if defined(__UNIX_JACK__)
+#include <jack/jack.h>
+#endif
+
+#if defined(__APPLE__)
+#include <mach/mach_time.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
 /* Lock over input buffer. */
 ofMutex mutex;
 
-/* Callback function for RtAudio. Copies input to a global buffer. */
+/* Callback function for RtAudio. Hands input to the owning AudioInput. */
 int callback(void* output, void* input, unsigned int numFrames,
              double streamTime, RtAudioStreamStatus status, void* data) 
 {
+    double hostTime = AudioInput::GetHostTime();
+    
 	// Setup buffer pointers.
 	// float corresponds to |RTAUDIO_FLOAT32|.
-	float* externalBuffer = *(float**)data;
+	AudioInput* audioInput = (AudioInput*)data;
     float* outputBuffer = (float*)output;
     float* inputBuffer = (float*)input;
     
-    mutex.lock();
-    for (int i = 0; i < numFrames; i++) {
-        outputBuffer[i] = 0.f;
-        externalBuffer[i] = inputBuffer[i];
+    if (outputBuffer) {
+        memset(outputBuffer, 0, sizeof(float) * numFrames);
     }
-    mutex.unlock();
+    audioInput->ReceiveInput(inputBuffer, numFrames, streamTime, hostTime);
     
     return 0;
 }
 
-AudioInput::AudioInput(long samplingRate, unsigned int numFrames)
-	: samplingRate(samplingRate), numFrames(numFrames)
+AudioInput::AudioInput(long samplingRate, unsigned int numFrames,
+                       long analysisRate, Resampler::Quality quality)
+	: samplingRate(samplingRate), requestedRate(samplingRate), numFrames(numFrames),
+      quality(quality)
 {
+    this->analysisRate = (analysisRate > 0) ? analysisRate : samplingRate;
+    
+    // Start out on the first API that works.
+    audio = new RtAudio();
+    
 	// Check if the user has an input device.
-	if (audio.getDeviceCount() < 1) {
+	if (audio->getDeviceCount() < 1) {
         std::string warning = "You need at least one audio input device!";
     	std::cout << warning << std::endl;
     }
 
     // Enable log warnings.
-    audio.showWarnings(true);
+    audio->showWarnings(true);
 
     // Allocate buffer for audio input frames
     input = new float[numFrames];
     memset(input, 0, numFrames * sizeof(float));
     
+    // Allocate window history.
+    history = new float[historySize * numFrames];
+    memset(history, 0, historySize * numFrames * sizeof(float));
+    
+    // Setup resampling from device rate to analysis rate.
+    ConfigureResampler();
+    
     // Initialize FFT window.
     FFTWindow = new float[numFrames];
     hanning(FFTWindow, numFrames);
@@ -49,7 +75,7 @@ AudioInput::AudioInput(long samplingRate, unsigned int numFrames)
     mode = aubio_pitchm_freq;
     type = aubio_pitch_yinfft;
     aubioInput = new_fvec(hopSize, 1);
-    pitchOutput = new_aubio_pitchdetection(windowSize, hopSize, 1, (ba_uint_t)samplingRate, type, mode);
+    pitchOutput = new_aubio_pitchdetection(windowSize, hopSize, 1, (ba_uint_t)this->analysisRate, type, mode);
     aubioInitFinished = true;
 }
 
@@ -59,18 +85,25 @@ AudioInput::~AudioInput()
 	Stop();
 
 	// Close audio stream.
-    if (audio.isStreamOpen()) {
-        audio.closeStream();
+    if (audio->isStreamOpen()) {
+        audio->closeStream();
     }
+    delete audio;
 
     mutex.lock();
     
     // Delete audio buffer
     delete[] input;
+    delete[] history;
     
     // Delete FFT window
     delete[] FFTWindow;
     
+    // Delete resampler
+    delete resampler;
+    delete[] resampled;
+    delete levelMeter;
+    
     // Delete aubio variables.
     del_aubio_pitchdetection(pitchOutput);
     del_fvec(aubioInput);
@@ -83,57 +116,352 @@ AudioInput::~AudioInput()
 void AudioInput::Start()
 {
 	// Abort if the audio stream is already running.
-	if (audio.isStreamRunning()) {
+	if (audio->isStreamRunning()) {
 		return;
 	}
+    
+    // Close a stream left over from a previous device.
+    if (audio->isStreamOpen()) {
+        audio->closeStream();
+    }
 
 	// Setup input params.
     RtAudio::StreamParameters inputParams;
-    inputParams.deviceId = audio.getDefaultInputDevice();
+    inputParams.deviceId = useDefaultDevice ? audio->getDefaultInputDevice() : inputDevice;
     inputParams.nChannels = 1;
-    inputParams.firstChannel = 0;
+    inputParams.firstChannel = inputChannel;
+    MatchDeviceRate(inputParams.deviceId);
 
-    // Setup output params.
+    // Setup output params. JACK streams are input-only, so we don't add
+    // silent playback ports to the graph.
     RtAudio::StreamParameters outputParams;
-    outputParams.deviceId = audio.getDefaultOutputDevice();
+    outputParams.deviceId = audio->getDefaultOutputDevice();
     outputParams.nChannels = 1;
     outputParams.firstChannel = 0;
+    RtAudio::StreamParameters* output = &outputParams;
+    if (GetApi() == RtAudio::UNIX_JACK) {
+        output = NULL;
+    }
+    
+    // Setup stream options.
+    RtAudio::StreamOptions options;
+    options.streamName = clientName;
+    
+    // Ask for about one analysis window per callback. JACK overrides this
+    // with the server's period size.
+    bufferFrames = (unsigned int)(numFrames / resampler->GetRatio());
 
     try {
         // Open audio stream.
-        audio.openStream(&outputParams, &inputParams, 
-                         RTAUDIO_FLOAT32, samplingRate,
-                         &numFrames, &callback, (void*)&input);
+        audio->openStream(output, &inputParams, 
+                          RTAUDIO_FLOAT32, samplingRate,
+                          &bufferFrames, &callback, (void*)this, &options);
+        
+        // RtAudio may have picked a different buffer size.
+        if (resampler->GetMaxOutputFrames(bufferFrames) > resampledCapacity) {
+            delete[] resampled;
+            resampledCapacity = resampler->GetMaxOutputFrames(bufferFrames);
+            resampled = new float[resampledCapacity];
+        }
+
+        // Remember the input latency for timestamping. RtAudio reports
+        // the sum of input and output latency for duplex streams.
+        inputLatency = (double)audio->getStreamLatency() / samplingRate;
 
         // Play audio stream.
-        audio.startStream();
+        audio->startStream();
     }
-    catch (int error) {
-        std::cout << "Unexpected playback error";
+    catch (RtError& error) {
+        std::cout << "Could not start audio input: " << error.getMessage() << std::endl;
         return;
     }
 }
 
 void AudioInput::Stop()
 {
-	if (audio.isStreamRunning()) {
-		audio.stopStream();
+	if (audio->isStreamRunning()) {
+		audio->stopStream();
 	}
 }
 
+void AudioInput::ReceiveInput(float* deviceInput, unsigned int deviceFrames,
+                              double streamTime, double hostTime)
+{
+    // Process in chunks no bigger than the buffer size the scratch space
+    // was allocated for.
+    while (deviceFrames > 0) {
+        unsigned int chunk = min(deviceFrames, bufferFrames);
+        unsigned int count = resampler->Process(deviceInput, chunk, resampled);
+        deviceInput += chunk;
+        deviceFrames -= chunk;
+        
+        // Update levels outside the lock; readers don't need it.
+        levelMeter->Process(resampled, count);
+        
+        // Slide the analysis window and append the new samples.
+        mutex.lock();
+        if (count >= numFrames) {
+            memcpy(input, resampled + (count - numFrames), sizeof(float) * numFrames);
+        }
+        else {
+            memmove(input, input + count, sizeof(float) * (numFrames - count));
+            memcpy(input + (numFrames - count), resampled, sizeof(float) * count);
+        }
+        mutex.unlock();
+    }
+    
+    // Record the new window in history.
+    mutex.lock();
+    historyHead = (historyHead + 1) % historySize;
+    historyCount = min(historyCount + 1, historySize);
+    memcpy(history + historyHead * numFrames, input, sizeof(float) * numFrames);
+    historyTimes[historyHead].streamTime = streamTime;
+    historyTimes[historyHead].hostTime = hostTime - inputLatency;
+    mutex.unlock();
+}
+
 float AudioInput::GetFrequencyResolution() {
-    return samplingRate / 2.f;
+    return analysisRate / 2.f;
 }
 
-float AudioInput::GetCurrentAmplitude() {
-    float rmsAmplitude = 0;
-    mutex.lock();
-    for (int i = 0; i < numFrames; i++) {
-        rmsAmplitude += sqrt(input[i] * input[i]);
+long AudioInput::GetAnalysisRate() {
+    return analysisRate;
+}
+
+void AudioInput::ConfigureResampler()
+{
+    delete resampler;
+    resampler = new Resampler(samplingRate, analysisRate, quality);
+    if (resampler->IsPassthrough()) {
+        analysisRate = samplingRate;
     }
-    mutex.unlock();
-    rmsAmplitude /= numFrames;
-    return rmsAmplitude;
+    
+    delete[] resampled;
+    bufferFrames = (unsigned int)(numFrames / resampler->GetRatio());
+    resampledCapacity = resampler->GetMaxOutputFrames(bufferFrames);
+    resampled = new float[resampledCapacity];
+    
+    // Meter over one analysis window, at the (possibly changed) rate.
+    delete levelMeter;
+    levelMeter = new LevelMeter(analysisRate, (float)numFrames / analysisRate);
+}
+
+void AudioInput::MatchDeviceRate(unsigned int deviceId)
+{
+    // Start from the requested rate rather than whatever the previous
+    // device ended up running at.
+    long deviceRate = requestedRate;
+    RtAudio::DeviceInfo info;
+    try {
+        info = audio->getDeviceInfo(deviceId);
+    }
+    catch (RtError& error) {
+        info.probed = false;
+    }
+    std::vector<unsigned int>& rates = info.sampleRates;
+    if (info.probed && !rates.empty() &&
+        std::find(rates.begin(), rates.end(), requestedRate) == rates.end()) {
+        // Take the lowest rate that still covers the analysis rate.
+        deviceRate = rates.back();
+        for (size_t i = 0; i < rates.size(); i++) {
+            if (rates[i] >= analysisRate) {
+                deviceRate = rates[i];
+                break;
+            }
+        }
+        std::cout << info.name << " runs at " << deviceRate << " Hz, resampling to "
+                  << analysisRate << " Hz for analysis." << std::endl;
+    }
+    if (deviceRate != samplingRate) {
+        samplingRate = deviceRate;
+        ConfigureResampler();
+    }
+}
+
+std::vector<RtAudio::Api> AudioInput::GetCompiledApis()
+{
+    std::vector<RtAudio::Api> apis;
+    RtAudio::getCompiledApi(apis);
+    return apis;
+}
+
+std::string AudioInput::GetApiName(RtAudio::Api api)
+{
+    switch (api) {
+        case RtAudio::LINUX_ALSA:
+            return "alsa";
+        case RtAudio::LINUX_OSS:
+            return "oss";
+        case RtAudio::UNIX_JACK:
+            return "jack";
+        case RtAudio::MACOSX_CORE:
+            return "core";
+        case RtAudio::WINDOWS_ASIO:
+            return "asio";
+        case RtAudio::WINDOWS_DS:
+            return "ds";
+        case RtAudio::RTAUDIO_DUMMY:
+            return "dummy";
+        default:
+            return "unspecified";
+    }
+}
+
+RtAudio::Api AudioInput::GetApiByName(const std::string& name)
+{
+    std::vector<RtAudio::Api> apis;
+    apis.push_back(RtAudio::LINUX_ALSA);
+    apis.push_back(RtAudio::LINUX_OSS);
+    apis.push_back(RtAudio::UNIX_JACK);
+    apis.push_back(RtAudio::MACOSX_CORE);
+    apis.push_back(RtAudio::WINDOWS_ASIO);
+    apis.push_back(RtAudio::WINDOWS_DS);
+    apis.push_back(RtAudio::RTAUDIO_DUMMY);
+    for (size_t i = 0; i < apis.size(); i++) {
+        if (GetApiName(apis[i]) == name) {
+            return apis[i];
+        }
+    }
+    return RtAudio::UNSPECIFIED;
+}
+
+bool AudioInput::SetApi(RtAudio::Api api)
+{
+    Stop();
+    if (audio->isStreamOpen()) {
+        audio->closeStream();
+    }
+    delete audio;
+    
+    audio = new RtAudio(api);
+    audio->showWarnings(true);
+    useDefaultDevice = true;
+    inputChannel = 0;
+    
+    if (api != RtAudio::UNSPECIFIED && audio->getCurrentApi() != api) {
+        std::cout << "Audio API \"" << GetApiName(api) << "\" is not available, using \""
+                  << GetApiName(audio->getCurrentApi()) << "\" instead." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+RtAudio::Api AudioInput::GetApi()
+{
+    return audio->getCurrentApi();
+}
+
+std::vector<RtAudio::DeviceInfo> AudioInput::GetDevices()
+{
+    std::vector<RtAudio::DeviceInfo> devices;
+    unsigned int count = audio->getDeviceCount();
+    for (unsigned int i = 0; i < count; i++) {
+        try {
+            devices.push_back(audio->getDeviceInfo(i));
+        }
+        catch (RtError& error) {
+            // Keep ids lined up with device indices.
+            devices.push_back(RtAudio::DeviceInfo());
+        }
+    }
+    return devices;
+}
+
+void AudioInput::SetInputDevice(unsigned int deviceId, unsigned int firstChannel)
+{
+    bool wasRunning = audio->isStreamRunning();
+    Stop();
+    
+    useDefaultDevice = false;
+    inputDevice = deviceId;
+    inputChannel = firstChannel;
+    
+    if (wasRunning) {
+        Start();
+    }
+}
+
+bool AudioInput::SetInputDevice(const std::string& name)
+{
+    int deviceId = FindDevice(name);
+    if (deviceId < 0) {
+        std::cout << "No audio device named \"" << name << "\"." << std::endl;
+        return false;
+    }
+    SetInputDevice(deviceId);
+    return true;
+}
+
+bool AudioInput::SetInputPort(const std::string& portName)
+{
+#if defined(__UNIX_JACK__)
+    if (GetApi() != RtAudio::UNIX_JACK) {
+        std::cout << "JACK ports can only be used with the JACK API." << std::endl;
+        return false;
+    }
+    
+    // RtApiJack treats each JACK client as a device, and a device's channels
+    // are its output ports in the order jack_get_ports() lists them for the
+    // client name. Find our port's position in that same list.
+    std::string deviceName = portName.substr(0, portName.find(":"));
+    int deviceId = FindDevice(deviceName);
+    if (deviceId < 0) {
+        std::cout << "No JACK client named \"" << deviceName << "\"." << std::endl;
+        return false;
+    }
+    
+    jack_client_t* client = jack_client_open("vroomvroom-probe", JackNoStartServer, NULL);
+    if (!client) {
+        std::cout << "JACK server not found." << std::endl;
+        return false;
+    }
+    int channel = -1;
+    const char** ports = jack_get_ports(client, deviceName.c_str(), NULL, JackPortIsOutput);
+    if (ports) {
+        for (int i = 0; ports[i]; i++) {
+            if (portName == ports[i]) {
+                channel = i;
+                break;
+            }
+        }
+        free(ports);
+    }
+    jack_client_close(client);
+    
+    if (channel < 0) {
+        std::cout << "No JACK output port named \"" << portName << "\"." << std::endl;
+        return false;
+    }
+    SetInputDevice(deviceId, channel);
+    return true;
+#else
+    std::cout << "Built without JACK support, can't connect to \"" << portName << "\"." << std::endl;
+    return false;
+#endif
+}
+
+void AudioInput::SetClientName(const std::string& name)
+{
+    clientName = name;
+}
+
+int AudioInput::FindDevice(const std::string& name)
+{
+    std::vector<RtAudio::DeviceInfo> devices = GetDevices();
+    for (size_t i = 0; i < devices.size(); i++) {
+        if (devices[i].probed && devices[i].name == name) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+float AudioInput::GetCurrentAmplitude() {
+    return levelMeter->GetReadings().rms;
+}
+
+LevelReadings AudioInput::GetLevels() {
+    return levelMeter->GetReadings();
 }
 
 float AudioInput::GetCurrentPitch() {
@@ -184,16 +512,102 @@ float* AudioInput::GetCurrentInput()
 }
 
 complex* AudioInput::GetTransformedInput()
+{
+    mutex.lock();
+    complex* output = Transform(input);
+    mutex.unlock();
+    return output;
+}
+
+float* AudioInput::GetInputAt(double hostTime, AudioTimestamp* timestamp)
+{
+    float* inputCopy = new float[numFrames];
+    
+    mutex.lock();
+    if (historyCount == 0) {
+        memcpy(inputCopy, input, sizeof(float) * numFrames);
+        if (timestamp) {
+            *timestamp = AudioTimestamp();
+        }
+        mutex.unlock();
+        return inputCopy;
+    }
+    
+    // Match against window midpoints rather than the newest sample.
+    double halfWindow = 0.5 * numFrames / analysisRate;
+    
+    // Walk back from the newest window to the first one that is not
+    // newer than the requested time.
+    unsigned int newer = historyHead;
+    unsigned int older = historyHead;
+    for (unsigned int i = 0; i < historyCount; i++) {
+        older = (historyHead + historySize - i) % historySize;
+        if (historyTimes[older].hostTime - halfWindow <= hostTime) {
+            break;
+        }
+        newer = older;
+    }
+    
+    // Use whichever of the two windows around the requested time is
+    // nearer. Blending them sample by sample would mix two different
+    // stretches of audio that partly cancel each other out.
+    double ta = historyTimes[older].hostTime - halfWindow;
+    double tb = historyTimes[newer].hostTime - halfWindow;
+    unsigned int nearest = (hostTime - ta <= tb - hostTime) ? older : newer;
+    memcpy(inputCopy, history + nearest * numFrames, sizeof(float) * numFrames);
+    if (timestamp) {
+        *timestamp = historyTimes[nearest];
+    }
+    mutex.unlock();
+    
+    return inputCopy;
+}
+
+complex* AudioInput::GetTransformedInputAt(double hostTime, AudioTimestamp* timestamp)
+{
+    float* frame = GetInputAt(hostTime, timestamp);
+    complex* output = Transform(frame);
+    delete[] frame;
+    return output;
+}
+
+AudioTimestamp AudioInput::GetLatestTimestamp()
+{
+    mutex.lock();
+    AudioTimestamp timestamp = historyTimes[historyHead];
+    mutex.unlock();
+    return timestamp;
+}
+
+double AudioInput::GetHostTime()
+{
+#if defined(__APPLE__)
+    static mach_timebase_info_data_t timebase;
+    if (timebase.denom == 0) {
+        mach_timebase_info(&timebase);
+    }
+    return (double)mach_absolute_time() * timebase.numer / timebase.denom * 1e-9;
+#elif defined(_WIN32)
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart / frequency.QuadPart;
+#else
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+#endif
+}
+
+complex* AudioInput::Transform(const float* frame)
 {
     // Copy input to float buffer of twice the length.
     float* inputCopy = new float[numFrames * 2];
     memset(inputCopy, 0, sizeof(float) * numFrames * 2);
-    mutex.lock();
-    memcpy(inputCopy, input, sizeof(float) * numFrames);
-    mutex.unlock();
+    memcpy(inputCopy, frame, sizeof(float) * numFrames);
     
     // Apply FFT window and perform FFT.
     apply_window(inputCopy, FFTWindow, numFrames);
     rfft(inputCopy, numFrames, FFT_FORWARD);
     return (complex*)inputCopy;
-}
\ No newline at end of file
+}
@@ -5,13 +5,32 @@
 #include "RtAudio.h"
 #include "chuck_fft.h"
 #include "aubio.h"
+#include "resampler.h"
+#include "level_meter.h"
+
+/* Timing of a captured block of audio. */
+struct AudioTimestamp {
+    /* Stream time reported by RtAudio for the block, in seconds. */
+    double streamTime = 0.0;
+    
+    /* Monotonic host time (see AudioInput::GetHostTime()) at which the
+     * newest sample of the block was captured, corrected for the stream's
+     * reported input latency. */
+    double hostTime = 0.0;
+};
 
 /* Wrapper class around RtAudio. */
 class AudioInput
 {
 public:
-	/* Initializes RtAudio library. */
-	AudioInput(long samplingRate, unsigned int numFrames);
+	/* Initializes RtAudio library. |samplingRate| is the device rate and
+     * |numFrames| the analysis window size. If |analysisRate| is nonzero
+     * and differs from the device rate, captured audio is resampled to it
+     * before analysis, which keeps the analysis cost independent of the
+     * device rate. */
+	AudioInput(long samplingRate, unsigned int numFrames,
+               long analysisRate = 0,
+               Resampler::Quality quality = Resampler::Fastest);
 	~AudioInput();
 
 	/* Start listening for audio input. */
@@ -21,12 +40,17 @@ public:
 	void Stop();
     
     /* Gets the maximum possible frequency that can be resolved by the
-     * Fourier transform for the given sampling rate. */
+     * Fourier transform for the analysis rate. */
     float GetFrequencyResolution();
     
-    /* Gets the amplitude of the current mic input. */
+    /* Gets the amplitude (true RMS over one analysis window) of the
+     * current mic input. Doesn't lock. */
     float GetCurrentAmplitude();
     
+    /* Gets RMS, peak, envelope and loudness readings of the mic input.
+     * Doesn't lock. */
+    LevelReadings GetLevels();
+    
     /* Gets the pitch of the current mic input. Uses aubio library to
      * perform estimate. */
     float GetCurrentPitch();
@@ -39,13 +63,124 @@ public:
      * will contain |numFrames| complex numbers, which is |numFrames * 2|
      * floats. The buffer must be freed by the user. */
     complex* GetTransformedInput();
+    
+    /* Like GetCurrentInput(), but picks the analysis window from recent
+     * history whose midpoint is closest to |hostTime|. Times newer than
+     * the latest capture clamp to the latest window. If |timestamp| is
+     * given it receives the timing of the window that was used. */
+    float* GetInputAt(double hostTime, AudioTimestamp* timestamp = NULL);
+    
+    /* Fourier-transformed version of GetInputAt(). */
+    complex* GetTransformedInputAt(double hostTime, AudioTimestamp* timestamp = NULL);
+    
+    /* Gets the timing of the most recently captured block. */
+    AudioTimestamp GetLatestTimestamp();
+    
+    /* Gets a monotonic clock reading in seconds, in the same time base as
+     * AudioTimestamp::hostTime. */
+    static double GetHostTime();
+    
+    /* Gets the rate the analysis buffers are sampled at. */
+    long GetAnalysisRate();
+    
+    /* Gets the audio APIs compiled into this build. */
+    static std::vector<RtAudio::Api> GetCompiledApis();
+    
+    /* Converts between APIs and their short names ("alsa", "jack", "oss",
+     * "core", "asio", "ds", "dummy"). Unknown names map to UNSPECIFIED. */
+    static std::string GetApiName(RtAudio::Api api);
+    static RtAudio::Api GetApiByName(const std::string& name);
+    
+    /* Switches to a different audio API. Any open stream is closed and the
+     * input device reverts to the API's default. Returns false if |api|
+     * is not available, in which case RtAudio picks a compiled one. */
+    bool SetApi(RtAudio::Api api);
+    
+    /* Gets the audio API currently in use. */
+    RtAudio::Api GetApi();
+    
+    /* Lists the devices of the current API. A device's index in the list
+     * is its device id. */
+    std::vector<RtAudio::DeviceInfo> GetDevices();
+    
+    /* Selects the input device (and first channel) to capture from. A
+     * running stream is restarted on the new device. */
+    void SetInputDevice(unsigned int deviceId, unsigned int firstChannel = 0);
+    
+    /* Selects the input device by name. Returns false if not found. */
+    bool SetInputDevice(const std::string& name);
+    
+    /* Captures from a named JACK output port such as "system:capture_1".
+     * Only available with the JACK API. Returns false if the port can't
+     * be found. */
+    bool SetInputPort(const std::string& portName);
+    
+    /* Sets the client name the stream registers under (JACK only). */
+    void SetClientName(const std::string& name);
 
 private:
+    friend int callback(void* output, void* input, unsigned int numFrames,
+                        double streamTime, RtAudioStreamStatus status, void* data);
+    
+    /* Resamples a block of device input and appends it to the analysis
+     * window. Called from the audio thread. */
+    void ReceiveInput(float* deviceInput, unsigned int deviceFrames,
+                      double streamTime, double hostTime);
+    
+    /* Windows and transforms a copy of an analysis window. */
+    complex* Transform(const float* frame);
+    
+    /* Rebuilds the resampler for the current device and analysis rates. */
+    void ConfigureResampler();
+    
+    /* Runs at the requested rate if the device supports it, and otherwise
+     * at the device's own rate, e.g. a JACK server running at a fixed
+     * rate. */
+    void MatchDeviceRate(unsigned int deviceId);
+    
+    /* Gets the id of the device called |name|, or -1. */
+    int FindDevice(const std::string& name);
+    
+	/* Rate the stream runs at, and the rate asked for at construction.
+     * They differ while a device can't run at the requested rate. */
 	long samplingRate = 44100;
+	long requestedRate = 44100;
+	long analysisRate = 44100;
 	unsigned int numFrames = 1024;
+    
+    /* Device buffer size, chosen so one callback covers about one
+     * analysis window. */
+    unsigned int bufferFrames = 1024;
 
-	/* Buffer to hold current audio input. */
+	/* Buffer to hold current audio input, at the analysis rate. */
 	float* input;
+    
+    /* Ring of the last |historySize| analysis windows, one per callback,
+     * with their timestamps. Guarded by the same lock as |input|. */
+    static const unsigned int historySize = 16;
+    float* history;
+    AudioTimestamp historyTimes[historySize];
+    unsigned int historyHead = 0;
+    unsigned int historyCount = 0;
+    
+    /* Input latency reported by the open stream, in seconds. */
+    double inputLatency = 0.0;
+    
+    /* Sample-rate conversion from device to analysis rate, and the scratch
+     * buffer it writes into. Only touched by the audio thread. */
+    Resampler* resampler = NULL;
+    Resampler::Quality quality;
+    float* resampled = NULL;
+    unsigned int resampledCapacity = 0;
+    
+    /* Level meter fed with analysis-rate samples from the audio thread. */
+    LevelMeter* levelMeter = NULL;
+    
+    /* Input device selection. */
+    bool useDefaultDevice = true;
+    unsigned int inputDevice = 0;
+    unsigned int inputChannel = 0;
+    std::string clientName = "vroomvroom";
     float* FFTWindow;
     
     /* Internal Aubio variables. */
@@ -57,8 +192,8 @@ private:
     fvec_t* aubioInput = NULL;
     bool aubioInitFinished = false;
 
-	/* Internal RtAudio object. */
-	RtAudio audio;
+	/* Internal RtAudio object. Recreated when the API changes. */
+	RtAudio* audio = NULL;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,212 @@
+#include "decimation.h"
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+#if defined(__SSE__)
+#include <xmmintrin.h>
+
+/* Lane-wise |mask| ? |a| : |b|. */
+static inline __m128 Select(__m128 mask, __m128 a, __m128 b)
+{
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+#endif
+
+/* Finds the lowest and highest of signal[begin, end). Ties go to the
+ * earliest sample. */
+static void FindMinMax(const float* signal, size_t begin, size_t end,
+                       size_t& minIndex, size_t& maxIndex)
+{
+    minIndex = maxIndex = begin;
+    size_t i = begin;
+
+#if defined(__SSE__)
+    // Keep a running min and max per lane, with the index it came from,
+    // then reduce the four lanes.
+    if (end - begin >= 8) {
+        __m128 index = _mm_setr_ps(begin, begin + 1, begin + 2, begin + 3);
+        __m128 four = _mm_set1_ps(4.f);
+        __m128 minValue = _mm_loadu_ps(signal + begin);
+        __m128 maxValue = minValue;
+        __m128 minAt = index;
+        __m128 maxAt = index;
+        for (i = begin + 4; i + 4 <= end; i += 4) {
+            index = _mm_add_ps(index, four);
+            __m128 value = _mm_loadu_ps(signal + i);
+            __m128 lower = _mm_cmplt_ps(value, minValue);
+            __m128 higher = _mm_cmpgt_ps(value, maxValue);
+            minValue = Select(lower, value, minValue);
+            minAt = Select(lower, index, minAt);
+            maxValue = Select(higher, value, maxValue);
+            maxAt = Select(higher, index, maxAt);
+        }
+        float mins[4], minIndices[4], maxs[4], maxIndices[4];
+        _mm_storeu_ps(mins, minValue);
+        _mm_storeu_ps(minIndices, minAt);
+        _mm_storeu_ps(maxs, maxValue);
+        _mm_storeu_ps(maxIndices, maxAt);
+        minIndex = (size_t)minIndices[0];
+        maxIndex = (size_t)maxIndices[0];
+        for (int lane = 1; lane < 4; lane++) {
+            size_t at = (size_t)minIndices[lane];
+            if (mins[lane] < signal[minIndex] || (mins[lane] == signal[minIndex] && at < minIndex)) {
+                minIndex = at;
+            }
+            at = (size_t)maxIndices[lane];
+            if (maxs[lane] > signal[maxIndex] || (maxs[lane] == signal[maxIndex] && at < maxIndex)) {
+                maxIndex = at;
+            }
+        }
+    }
+#endif
+    for (; i < end; i++) {
+        if (signal[i] < signal[minIndex]) {
+            minIndex = i;
+        }
+        if (signal[i] > signal[maxIndex]) {
+            maxIndex = i;
+        }
+    }
+}
+
+size_t DecimateMinMax(const float* signal, size_t length, size_t numBuckets,
+                      float* indices, float* values)
+{
+    numBuckets = std::min(numBuckets, length);
+    size_t count = 0;
+    for (size_t b = 0; b < numBuckets; b++) {
+        size_t begin = b * length / numBuckets;
+        size_t end = (b + 1) * length / numBuckets;
+        size_t minIndex, maxIndex;
+        FindMinMax(signal, begin, end, minIndex, maxIndex);
+
+        size_t first = std::min(minIndex, maxIndex);
+        size_t second = std::max(minIndex, maxIndex);
+        indices[count] = first;
+        values[count++] = signal[first];
+        if (second != first) {
+            indices[count] = second;
+            values[count++] = signal[second];
+        }
+    }
+    return count;
+}
+
+size_t DecimateLargestTriangle(const float* signal, size_t length, size_t numPoints,
+                               float* indices, float* values)
+{
+    if (numPoints >= length || numPoints < 3) {
+        numPoints = std::min(numPoints, length);
+        for (size_t i = 0; i < numPoints; i++) {
+            indices[i] = i;
+            values[i] = signal[i];
+        }
+        return numPoints;
+    }
+
+    // The first and last samples are kept; the rest of the signal is split
+    // into numPoints - 2 buckets. From each bucket, keep the sample that
+    // makes the largest triangle with the previous kept point and the mean
+    // of the next bucket.
+    double bucketSize = (double)(length - 2) / (numPoints - 2);
+    size_t count = 0;
+    size_t previous = 0;
+    indices[count] = 0;
+    values[count++] = signal[0];
+    for (size_t b = 0; b < numPoints - 2; b++) {
+        size_t begin = 1 + (size_t)(b * bucketSize);
+        size_t end = 1 + (size_t)((b + 1) * bucketSize);
+
+        size_t nextBegin = end;
+        size_t nextEnd = std::min(1 + (size_t)((b + 2) * bucketSize), length);
+        float nextX = 0.f, nextY = 0.f;
+        for (size_t i = nextBegin; i < nextEnd; i++) {
+            nextX += i;
+            nextY += signal[i];
+        }
+        nextX /= (nextEnd - nextBegin);
+        nextY /= (nextEnd - nextBegin);
+
+        // Twice the triangle's area for candidate (x, y) is
+        // |p * y + q * x + r|, with p, q, r fixed by the other two corners.
+        float ax = previous, ay = signal[previous];
+        float p = ax - nextX;
+        float q = nextY - ay;
+        float r = -p * ay - q * ax;
+
+        size_t best = begin;
+        float bestArea = -1.f;
+        size_t i = begin;
+#if defined(__SSE__)
+        if (end - begin >= 4) {
+            __m128 ps = _mm_set1_ps(p), qs = _mm_set1_ps(q), rs = _mm_set1_ps(r);
+            __m128 sign = _mm_set1_ps(-0.f);
+            __m128 four = _mm_set1_ps(4.f);
+            __m128 x = _mm_setr_ps(begin, begin + 1, begin + 2, begin + 3);
+            __m128 largest = _mm_set1_ps(-1.f);
+            __m128 largestAt = x;
+            for (; i + 4 <= end; i += 4) {
+                __m128 area = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ps, _mm_loadu_ps(signal + i)),
+                                                    _mm_mul_ps(qs, x)), rs);
+                area = _mm_andnot_ps(sign, area);
+                __m128 larger = _mm_cmpgt_ps(area, largest);
+                largest = Select(larger, area, largest);
+                largestAt = Select(larger, x, largestAt);
+                x = _mm_add_ps(x, four);
+            }
+            float areas[4], at[4];
+            _mm_storeu_ps(areas, largest);
+            _mm_storeu_ps(at, largestAt);
+            for (int lane = 0; lane < 4; lane++) {
+                if (areas[lane] > bestArea || (areas[lane] == bestArea && (size_t)at[lane] < best)) {
+                    bestArea = areas[lane];
+                    best = (size_t)at[lane];
+                }
+            }
+        }
+#endif
+        for (; i < end; i++) {
+            float area = fabsf(p * signal[i] + q * i + r);
+            if (area > bestArea) {
+                bestArea = area;
+                best = i;
+            }
+        }
+
+        indices[count] = best;
+        values[count++] = signal[best];
+        previous = best;
+    }
+    indices[count] = length - 1;
+    values[count++] = signal[length - 1];
+    return count;
+}
+
+void MakeWaveformPolyline(const float* signal, size_t length, float left, float right,
+                          float baseline, float gain, DecimationMethod method, ofMesh& mesh)
+{
+    std::vector<ofVec3f>& vertices = mesh.getVertices();
+    float increment = (right - left) / length;
+
+    // Two points per pixel is as much as a line can show.
+    size_t pixels = std::max(1, (int)(right - left));
+    if (length <= 2 * pixels) {
+        vertices.resize(length);
+        for (size_t i = 0; i < length; i++) {
+            vertices[i].set(left + i * increment, baseline + gain * signal[i], 0.f);
+        }
+        return;
+    }
+
+    std::vector<float> indices(2 * pixels);
+    std::vector<float> values(2 * pixels);
+    size_t count = (method == MinMaxDecimation)
+        ? DecimateMinMax(signal, length, pixels, &indices[0], &values[0])
+        : DecimateLargestTriangle(signal, length, 2 * pixels, &indices[0], &values[0]);
+    vertices.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        vertices[i].set(left + indices[i] * increment, baseline + gain * values[i], 0.f);
+    }
+}
@@ -0,0 +1,41 @@
+#ifndef DECIMATION_H
+#define DECIMATION_H
+
+#include <cstddef>
+
+#include "ofMain.h"
+
+/* Ways to thin a signal down to what a display can show. */
+enum DecimationMethod {
+    /* The lowest and highest sample of each bucket, in the order they
+     * occur. Keeps every peak, so the envelope looks exactly like the
+     * full signal's. */
+    MinMaxDecimation,
+
+    /* Largest-Triangle-Three-Buckets: one sample per bucket, picked to
+     * keep the polyline's shape. Smoother than min/max for the same
+     * number of points. */
+    LargestTriangleDecimation
+};
+
+/* Writes the sample index and value of the min and max of each of
+ * |numBuckets| equal runs of |signal| to |indices| and |values|, which
+ * hold 2 * |numBuckets| entries. Returns the number of points written. */
+size_t DecimateMinMax(const float* signal, size_t length, size_t numBuckets,
+                      float* indices, float* values);
+
+/* Picks |numPoints| samples of |signal| with LTTB, always including the
+ * first and last. |indices| and |values| hold |numPoints| entries.
+ * Returns the number of points written. */
+size_t DecimateLargestTriangle(const float* signal, size_t length, size_t numPoints,
+                               float* indices, float* values);
+
+/* Replaces |mesh|'s vertices with a polyline of |signal| spanning |left|
+ * to |right|, each sample drawn |gain| * value below or above |baseline|.
+ * Signals with more than about two samples per pixel are decimated with
+ * |method| first, so the vertex count follows the width on screen, not
+ * the signal length. */
+void MakeWaveformPolyline(const float* signal, size_t length, float left, float right,
+                          float baseline, float gain, DecimationMethod method, ofMesh& mesh);
+
+#endif
@@ -0,0 +1,160 @@
+#include "filterbank.h"
+
+#include <cmath>
+#include <algorithm>
+
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+Filterbank::Filterbank(Scale scale, unsigned int numBands, unsigned int numBins,
+                       float nyquist, float minFrequency, float maxFrequency)
+    : numBands(numBands), numBins(numBins)
+{
+    if (maxFrequency <= 0.f || maxFrequency > nyquist) {
+        maxFrequency = nyquist;
+    }
+    float binWidth = nyquist / numBins;
+
+    // Band edges, evenly spaced on the chosen scale. Band b rises from
+    // edge b, peaks at edge b + 1 and falls to edge b + 2.
+    std::vector<float> edges(numBands + 2);
+    float low = ToScale(scale, minFrequency);
+    float high = ToScale(scale, maxFrequency);
+    for (unsigned int i = 0; i < edges.size(); i++) {
+        edges[i] = FromScale(scale, low + (high - low) * i / (numBands + 1));
+    }
+
+    std::vector<float> band;
+    for (unsigned int b = 0; b < numBands; b++) {
+        float lower = edges[b];
+        float center = edges[b + 1];
+        float upper = edges[b + 2];
+        centers.push_back(center);
+
+        // Triangle over the bins that fall inside the band. Bin 0 is
+        // skipped: rfft() packs the Nyquist term into its imaginary part.
+        unsigned int first = std::max(1, (int)ceil(lower / binWidth));
+        unsigned int last = std::min(numBins - 1, (unsigned int)floor(upper / binWidth));
+        band.clear();
+        float sum = 0.f;
+        for (unsigned int i = first; i <= last; i++) {
+            float frequency = i * binWidth;
+            float weight = (frequency <= center)
+                ? (frequency - lower) / (center - lower)
+                : (upper - frequency) / (upper - center);
+            weight = std::max(0.f, weight);
+            band.push_back(weight);
+            sum += weight;
+        }
+
+        // Bass bands can be narrower than a bin. Interpolate between the
+        // two bins around the center instead.
+        if (sum <= 1e-6f) {
+            float position = std::min(center / binWidth, numBins - 1.f);
+            first = std::max(1u, (unsigned int)position);
+            first = std::min(first, numBins - 2);
+            float fraction = std::min(std::max(position - first, 0.f), 1.f);
+            band.clear();
+            band.push_back(1.f - fraction);
+            band.push_back(fraction);
+            sum = 1.f;
+        }
+
+        // Normalize and pad to whole vectors.
+        for (unsigned int i = 0; i < band.size(); i++) {
+            band[i] /= sum;
+        }
+        while (band.size() % 4 != 0) {
+            band.push_back(0.f);
+        }
+
+        firstBin.push_back(first);
+        binCount.push_back(band.size());
+        weightOffset.push_back(weights.size());
+        weights.insert(weights.end(), band.begin(), band.end());
+    }
+
+    magnitudes.resize(numBins + 4, 0.f);
+}
+
+void Filterbank::Process(const complex* spectrum, float* bands)
+{
+    const float* values = (const float*)spectrum;
+    float* output = &magnitudes[0];
+    unsigned int i = 0;
+
+#if defined(__SSE__)
+    // Deinterleave four bins at a time and take their magnitudes.
+    for (; i + 4 <= numBins; i += 4) {
+        __m128 a = _mm_loadu_ps(values + 2 * i);
+        __m128 b = _mm_loadu_ps(values + 2 * i + 4);
+        __m128 re = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+        __m128 im = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+        __m128 power = _mm_add_ps(_mm_mul_ps(re, re), _mm_mul_ps(im, im));
+        _mm_storeu_ps(output + i, _mm_sqrt_ps(power));
+    }
+#endif
+    for (; i < numBins; i++) {
+        output[i] = cmp_abs(spectrum[i]);
+    }
+
+    for (unsigned int b = 0; b < numBands; b++) {
+        const float* bins = output + firstBin[b];
+        const float* weight = &weights[weightOffset[b]];
+        unsigned int count = binCount[b];
+
+#if defined(__SSE__)
+        __m128 sum = _mm_setzero_ps();
+        for (unsigned int j = 0; j < count; j += 4) {
+            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(bins + j), _mm_loadu_ps(weight + j)));
+        }
+        float lanes[4];
+        _mm_storeu_ps(lanes, sum);
+        bands[b] = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#else
+        float sum = 0.f;
+        for (unsigned int j = 0; j < count; j++) {
+            sum += bins[j] * weight[j];
+        }
+        bands[b] = sum;
+#endif
+    }
+}
+
+unsigned int Filterbank::GetNumBands()
+{
+    return numBands;
+}
+
+float Filterbank::GetCenterFrequency(unsigned int band)
+{
+    return centers[band];
+}
+
+float Filterbank::ToScale(Scale scale, float frequency)
+{
+    switch (scale) {
+        case Mel:
+            return 2595.f * log10(1.f + frequency / 700.f);
+        case Bark:
+            // Traunmueller's approximation.
+            return 26.81f * frequency / (1960.f + frequency) - 0.53f;
+        case ConstantQ:
+        default:
+            return log2(std::max(frequency, 1.f));
+    }
+}
+
+float Filterbank::FromScale(Scale scale, float value)
+{
+    switch (scale) {
+        case Mel:
+            return 700.f * (pow(10.f, value / 2595.f) - 1.f);
+        case Bark:
+            return 1960.f * (value + 0.53f) / (26.28f - value);
+        case ConstantQ:
+        default:
+            return pow(2.f, value);
+    }
+}
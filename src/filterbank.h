@@ -0,0 +1,61 @@
+#ifndef FILTERBANK_H
+#define FILTERBANK_H
+
+#include <vector>
+
+#include "chuck_fft.h"
+
+/* Maps FFT bins onto a smaller number of perceptually spaced bands. The
+ * band weights are computed once, stored sparsely (each band only keeps
+ * the run of bins it overlaps), and applied with SSE where available. */
+class Filterbank
+{
+public:
+    /* Frequency scale the bands are evenly spaced on. */
+    enum Scale {
+        Mel,
+        Bark,
+        ConstantQ
+    };
+
+    /* Creates |numBands| overlapping triangular bands between
+     * |minFrequency| and |maxFrequency| (0 means |nyquist|), for spectra
+     * of |numBins| bins spanning 0 to |nyquist| Hz, as returned by
+     * AudioInput::GetTransformedInput(). */
+    Filterbank(Scale scale, unsigned int numBands, unsigned int numBins,
+               float nyquist, float minFrequency = 30.f, float maxFrequency = 0.f);
+
+    /* Writes the magnitude of each band of |spectrum| into |bands|, which
+     * must hold GetNumBands() floats. Band magnitudes are weighted means of
+     * bin magnitudes, so they're on the same scale as cmp_abs(). */
+    void Process(const complex* spectrum, float* bands);
+
+    /* Gets the number of bands. */
+    unsigned int GetNumBands();
+
+    /* Gets the center frequency of |band| in Hz. */
+    float GetCenterFrequency(unsigned int band);
+
+    /* Converts between Hz and the given scale. */
+    static float ToScale(Scale scale, float frequency);
+    static float FromScale(Scale scale, float value);
+
+private:
+    unsigned int numBands;
+    unsigned int numBins;
+
+    /* Sparse weights: band b covers bins [firstBin[b], firstBin[b] +
+     * binCount[b]), with weights starting at weights[weightOffset[b]].
+     * Counts are padded to a multiple of 4 with zero weights. */
+    std::vector<unsigned int> firstBin;
+    std::vector<unsigned int> binCount;
+    std::vector<unsigned int> weightOffset;
+    std::vector<float> weights;
+    std::vector<float> centers;
+
+    /* Bin magnitudes for the spectrum being processed, zero-padded so
+     * padded bands can read past the last bin. */
+    std::vector<float> magnitudes;
+};
+
+#endif
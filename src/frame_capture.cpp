@@ -0,0 +1,245 @@
+#include "frame_capture.h"
+
+#include <cmath>
+
+/* Reads kept in flight. A read is collected this many frames after it was
+ * started, by which time the copy has finished and mapping doesn't wait. */
+static const int kReadbackLatency = 2;
+
+/* Frames the writer may fall behind by before frames are dropped. */
+static const size_t kMaxQueuedFrames = 8;
+
+FrameCapture::FrameCapture()
+{
+}
+
+FrameCapture::~FrameCapture()
+{
+    Stop();
+}
+
+FrameCapture::Format FrameCapture::GetFormatForPath(const std::string& path)
+{
+    return ofToLower(ofFilePath::getFileExt(path)) == "y4m" ? Y4M : PngSequence;
+}
+
+bool FrameCapture::Start(const std::string& newPath, Format newFormat, int newWidth, int newHeight,
+                         float newFrameRate)
+{
+    Stop();
+    format = newFormat;
+    path = ofToDataPath(newPath, true);
+    width = newWidth;
+    height = newHeight;
+    frameRate = newFrameRate;
+
+    if (format == Y4M) {
+        video = fopen(path.c_str(), "wb");
+        if (!video) {
+            ofLogError("FrameCapture") << "can't create " << path;
+            return false;
+        }
+        // Frame rate as a ratio with millihertz precision.
+        fprintf(video, "YUV4MPEG2 W%d H%d F%d:1000 Ip A1:1 C444\n",
+                width, height, (int)roundf(frameRate * 1000.f));
+    }
+    else if (!ofDirectory::createDirectory(path, false, true)) {
+        ofLogError("FrameCapture") << "can't create " << path;
+        return false;
+    }
+
+    pbos.resize(kReadbackLatency + 1);
+    glGenBuffers(pbos.size(), &pbos[0]);
+    for (size_t i = 0; i < pbos.size(); i++) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[i]);
+        glBufferData(GL_PIXEL_PACK_BUFFER, width * height * 3, NULL, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    issued = collected = 0;
+    captured = dropped = 0;
+    written = 0;
+    recording = true;
+    startThread(true, false);
+    ofLogNotice("FrameCapture") << "recording " << width << "x" << height << " to " << path;
+    return true;
+}
+
+void FrameCapture::SetBlocking(bool newBlocking)
+{
+    blocking = newBlocking;
+}
+
+void FrameCapture::Capture(int frameWidth, int frameHeight)
+{
+    if (!recording) {
+        return;
+    }
+    if (frameWidth != width || frameHeight != height) {
+        dropped++;
+        return;
+    }
+
+    // Start reading this frame. glReadPixels into a bound pack buffer
+    // returns as soon as the copy is queued.
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadBuffer(GL_BACK);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[issued % pbos.size()]);
+    glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, 0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    issued++;
+
+    if (issued - collected > kReadbackLatency) {
+        CollectReadback();
+    }
+}
+
+void FrameCapture::CollectReadback()
+{
+    ofPixels* frame = NULL;
+    lock();
+    while (blocking && queue.size() >= kMaxQueuedFrames) {
+        unlock();
+        sleep(1);
+        lock();
+    }
+    if (queue.size() < kMaxQueuedFrames) {
+        if (spare.empty()) {
+            frame = new ofPixels();
+            frame->allocate(width, height, 3);
+        }
+        else {
+            frame = spare.back();
+            spare.pop_back();
+        }
+    }
+    unlock();
+
+    if (frame) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[collected % pbos.size()]);
+        unsigned char* pixels = (unsigned char*)glMapBuffer(GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+        if (pixels) {
+            memcpy(frame->getPixels(), pixels, width * height * 3);
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        lock();
+        if (pixels) {
+            queue.push_back(frame);
+            captured++;
+        }
+        else {
+            spare.push_back(frame);
+            dropped++;
+        }
+        unlock();
+    }
+    else {
+        dropped++;
+    }
+    collected++;
+}
+
+void FrameCapture::Stop()
+{
+    if (!recording) {
+        return;
+    }
+    while (collected < issued) {
+        CollectReadback();
+    }
+    glDeleteBuffers(pbos.size(), &pbos[0]);
+    pbos.clear();
+
+    // The writer drains the queue before it exits.
+    waitForThread(true);
+    if (video) {
+        fclose(video);
+        video = NULL;
+    }
+    for (size_t i = 0; i < spare.size(); i++) {
+        delete spare[i];
+    }
+    spare.clear();
+    recording = false;
+    ofLogNotice("FrameCapture") << "wrote " << written << " frames to " << path
+        << ", dropped " << dropped;
+}
+
+bool FrameCapture::IsRecording()
+{
+    return recording;
+}
+
+int FrameCapture::GetNumCaptured()
+{
+    return captured;
+}
+
+int FrameCapture::GetNumDropped()
+{
+    return dropped;
+}
+
+void FrameCapture::threadedFunction()
+{
+    while (true) {
+        lock();
+        ofPixels* frame = NULL;
+        if (!queue.empty()) {
+            frame = queue.front();
+            queue.pop_front();
+        }
+        bool running = isThreadRunning();
+        unlock();
+
+        if (!frame) {
+            if (!running) {
+                break;
+            }
+            sleep(2);
+            continue;
+        }
+        WriteFrame(*frame);
+
+        lock();
+        spare.push_back(frame);
+        unlock();
+    }
+}
+
+void FrameCapture::WriteFrame(ofPixels& frame)
+{
+    if (format == Y4M) {
+        WriteY4MFrame(frame);
+    }
+    else {
+        // Rows come back bottom up.
+        frame.mirror(true, false);
+        ofSaveImage(frame, path + "/" + ofToString(written, 6, '0') + ".png");
+    }
+    written++;
+}
+
+void FrameCapture::WriteY4MFrame(ofPixels& frame)
+{
+    // BT.601 studio range, one plane per channel, top row first.
+    size_t planeSize = width * height;
+    planes.resize(planeSize * 3);
+    unsigned char* y = &planes[0];
+    unsigned char* cb = y + planeSize;
+    unsigned char* cr = cb + planeSize;
+    const unsigned char* rgb = frame.getPixels();
+    for (int row = 0; row < height; row++) {
+        const unsigned char* src = rgb + (height - 1 - row) * width * 3;
+        for (int x = 0; x < width; x++, src += 3) {
+            int r = src[0], g = src[1], b = src[2];
+            *y++ = (unsigned char)(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+            *cb++ = (unsigned char)(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+            *cr++ = (unsigned char)(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+        }
+    }
+    fputs("FRAME\n", video);
+    fwrite(&planes[0], 1, planes.size(), video);
+}
@@ -0,0 +1,99 @@
+#ifndef FRAME_CAPTURE_H
+#define FRAME_CAPTURE_H
+
+#include <deque>
+#include <string>
+#include <vector>
+#include <cstdio>
+
+#include "ofMain.h"
+
+/* Records what's drawn in the window to disk without stalling the frame.
+ *
+ * Capture() starts an asynchronous read of the window into one of a ring
+ * of pixel buffer objects and collects the read started a couple of frames
+ * earlier, which the GPU has long finished by then. The pixels are handed
+ * to a writer thread that saves a PNG sequence or appends to a Y4M video.
+ * If the writer falls behind, frames are dropped and counted, unless the
+ * capture is blocking, in which case the render loop waits for it. */
+class FrameCapture : public ofThread
+{
+public:
+    enum Format {
+        /* Numbered PNG files in a directory. */
+        PngSequence,
+        
+        /* Uncompressed 4:4:4 YUV4MPEG2 video, which ffmpeg and most
+         * players read directly. */
+        Y4M
+    };
+
+    FrameCapture();
+    ~FrameCapture();
+
+    /* Y4M for paths ending in .y4m, else a PNG sequence. */
+    static Format GetFormatForPath(const std::string& path);
+
+    /* Starts recording |width| x |height| frames to |path|, relative to
+     * the data folder. |frameRate| is stored in the video header. Returns
+     * false if the output can't be created. Call from the GL thread. */
+    bool Start(const std::string& path, Format format, int width, int height, float frameRate);
+
+    /* Makes Capture() wait for the writer instead of dropping frames. Use
+     * for offline renders, where every frame matters more than the frame
+     * rate. */
+    void SetBlocking(bool blocking);
+
+    /* Reads back the window, which must be |width| x |height|. Frames of
+     * any other size are dropped. Call from the GL thread after drawing
+     * the frame. */
+    void Capture(int width, int height);
+
+    /* Collects the reads in flight, waits for the writer to finish and
+     * closes the output. Call from the GL thread. */
+    void Stop();
+
+    bool IsRecording();
+
+    /* Frames written or queued, and frames lost because the writer was
+     * behind or the window changed size. */
+    int GetNumCaptured();
+    int GetNumDropped();
+
+private:
+    /* Maps the oldest read in flight and queues its pixels. */
+    void CollectReadback();
+
+    void threadedFunction();
+    void WriteFrame(ofPixels& frame);
+    void WriteY4MFrame(ofPixels& frame);
+
+    bool recording = false;
+    bool blocking = false;
+    Format format = PngSequence;
+    std::string path;
+    int width = 0;
+    int height = 0;
+    float frameRate = 60.f;
+
+    /* Pixel buffer ring. |issued| reads have been started and |collected|
+     * of them queued or dropped. */
+    std::vector<GLuint> pbos;
+    int issued = 0;
+    int collected = 0;
+
+    /* Frames waiting for the writer, and spent frames for reuse. Guarded
+     * by the thread lock. */
+    std::deque<ofPixels*> queue;
+    std::vector<ofPixels*> spare;
+
+    int captured = 0;
+    int dropped = 0;
+
+    /* Writer thread only. */
+    FILE* video = NULL;
+    int written = 0;
+    std::vector<unsigned char> planes;
+};
+
+#endif
@@ -0,0 +1,248 @@
+#include "highway.h"
+
+#include <algorithm>
+#include <functional>
+
+/* Objects per chunk when placing in parallel. Below one chunk's worth
+ * the threads cost more than they save. */
+static const int kChunkSize = 512;
+
+Highway::Highway()
+{
+}
+
+int Highway::AddKind(const HighwayStyle& style)
+{
+    Kind kind;
+    kind.style = style;
+    kinds.push_back(kind);
+    return kinds.size() - 1;
+}
+
+HighwayStyle& Highway::GetStyle(int kind)
+{
+    return kinds[kind].style;
+}
+
+void Highway::Spawn(int k, const ofMesh& outline, float time, int block)
+{
+    Kind& kind = kinds[k];
+    int slot = -1;
+    ofVec3f boundsMin, boundsMax;
+    if (outline.getNumVertices() > 0) {
+        if (freeMeshes.empty()) {
+            meshes.push_back(ofVboMesh());
+            slot = meshes.size() - 1;
+        }
+        else {
+            slot = freeMeshes.back();
+            freeMeshes.pop_back();
+        }
+        ofMesh& mesh = meshes[slot];
+        mesh = outline;
+        
+        const std::vector<ofVec3f>& vertices = outline.getVertices();
+        boundsMin = boundsMax = vertices[0];
+        for (size_t i = 1; i < vertices.size(); i++) {
+            boundsMin.set(std::min(boundsMin.x, vertices[i].x), std::min(boundsMin.y, vertices[i].y),
+                          std::min(boundsMin.z, vertices[i].z));
+            boundsMax.set(std::max(boundsMax.x, vertices[i].x), std::max(boundsMax.y, vertices[i].y),
+                          std::max(boundsMax.z, vertices[i].z));
+        }
+        kind.outlineZMin = kind.hasOutlines ? std::min(kind.outlineZMin, boundsMin.z) : boundsMin.z;
+        kind.outlineZMax = kind.hasOutlines ? std::max(kind.outlineZMax, boundsMax.z) : boundsMax.z;
+        kind.hasOutlines = true;
+    }
+    kind.birth.push_back(time);
+    kind.age.push_back(0.f);
+    kind.z.push_back(kind.style.startZ);
+    kind.lineColor.push_back(kind.style.lineColor);
+    kind.fillColor.push_back(kind.style.fillColor);
+    kind.mesh.push_back(slot);
+    kind.block.push_back(slot < 0 ? block : -1);
+    kind.boundsMin.push_back(boundsMin);
+    kind.boundsMax.push_back(boundsMax);
+    kind.hit.push_back(false);
+}
+
+void Highway::Update(float time)
+{
+    for (size_t k = 0; k < kinds.size(); k++) {
+        Kind& kind = kinds[k];
+        int count = kind.birth.size();
+
+        // Aging and placing: independent per object, so chunks of the
+        // arrays go to different threads (OpenMP is enabled in
+        // config.make and the Xcode project).
+        int numChunks = (count + kChunkSize - 1) / kChunkSize;
+#ifdef _OPENMP
+#pragma omp parallel for if(numChunks > 1)
+#endif
+        for (int c = 0; c < numChunks; c++) {
+            Place(kind, c * kChunkSize, std::min(count, (c + 1) * kChunkSize), time);
+        }
+
+        // Expiry: compact the survivors forward in one pass, keeping
+        // their order.
+        int kept = 0;
+        for (int i = 0; i < count; i++) {
+            if (kind.age[i] >= 1.f) {
+                if (kind.mesh[i] >= 0) {
+                    freeMeshes.push_back(kind.mesh[i]);
+                }
+                continue;
+            }
+            if (kept != i) {
+                kind.birth[kept] = kind.birth[i];
+                kind.age[kept] = kind.age[i];
+                kind.z[kept] = kind.z[i];
+                kind.lineColor[kept] = kind.lineColor[i];
+                kind.fillColor[kept] = kind.fillColor[i];
+                kind.mesh[kept] = kind.mesh[i];
+                kind.block[kept] = kind.block[i];
+                kind.boundsMin[kept] = kind.boundsMin[i];
+                kind.boundsMax[kept] = kind.boundsMax[i];
+                kind.hit[kept] = kind.hit[i];
+            }
+            kept++;
+        }
+        kind.birth.resize(kept);
+        kind.age.resize(kept);
+        kind.z.resize(kept);
+        kind.lineColor.resize(kept);
+        kind.fillColor.resize(kept);
+        kind.mesh.resize(kept);
+        kind.block.resize(kept);
+        kind.boundsMin.resize(kept);
+        kind.boundsMax.resize(kept);
+        kind.hit.resize(kept);
+    }
+}
+
+void Highway::Place(Kind& kind, int begin, int end, float time)
+{
+    const HighwayStyle& style = kind.style;
+    float inverseLifetime = 1.f / style.lifetime;
+    for (int i = begin; i < end; i++) {
+        float age = (time - kind.birth[i]) * inverseLifetime;
+        float brightness = 1.f - std::min(age, 1.f);
+        kind.age[i] = age;
+        kind.z[i] = style.startZ + style.travelZ * age;
+        kind.lineColor[i] = ofColor(style.lineColor.r * brightness, style.lineColor.g * brightness,
+                                    style.lineColor.b * brightness, style.lineColor.a);
+        kind.fillColor[i] = ofColor(style.fillColor.r * brightness, style.fillColor.g * brightness,
+                                    style.fillColor.b * brightness, style.fillColor.a);
+    }
+}
+
+int Highway::GetNumObjects(int kind)
+{
+    if (kind >= 0) {
+        return kinds[kind].birth.size();
+    }
+    int count = 0;
+    for (size_t k = 0; k < kinds.size(); k++) {
+        count += kinds[k].birth.size();
+    }
+    return count;
+}
+
+int Highway::GetNumKinds()
+{
+    return kinds.size();
+}
+
+void Highway::FindInDepthRange(int k, float zMin, float zMax, std::vector<int>& objects)
+{
+    // An object reaches the range if its depth is within it, widened by
+    // how far any outline of the kind extends along z.
+    Kind& kind = kinds[k];
+    float low = zMin - kind.outlineZMax;
+    float high = zMax - kind.outlineZMin;
+
+    // Older objects have travelled further, so depths are sorted by birth:
+    // ascending if objects travel towards -z, descending otherwise.
+    std::vector<float>::iterator begin, end;
+    if (kind.style.travelZ < 0.f) {
+        begin = std::lower_bound(kind.z.begin(), kind.z.end(), low);
+        end = std::upper_bound(begin, kind.z.end(), high);
+    }
+    else {
+        begin = std::lower_bound(kind.z.begin(), kind.z.end(), high, std::greater<float>());
+        end = std::upper_bound(begin, kind.z.end(), low, std::greater<float>());
+    }
+    for (std::vector<float>::iterator i = begin; i != end; ++i) {
+        objects.push_back(i - kind.z.begin());
+    }
+}
+
+void Highway::GetBounds(int k, int object, ofVec3f& min, ofVec3f& max)
+{
+    Kind& kind = kinds[k];
+    ofVec3f offset(0.f, 0.f, kind.z[object]);
+    min = kind.boundsMin[object] + offset;
+    max = kind.boundsMax[object] + offset;
+}
+
+const ofMesh& Highway::GetOutline(int kind, int object)
+{
+    return meshes[kinds[kind].mesh[object]];
+}
+
+float Highway::GetDepth(int kind, int object)
+{
+    return kinds[kind].z[object];
+}
+
+void Highway::SetHit(int kind, int object)
+{
+    kinds[kind].hit[object] = true;
+}
+
+bool Highway::IsHit(int kind, int object)
+{
+    return kinds[kind].hit[object];
+}
+
+void Highway::Draw(bool flush, BlockDrawer& drawer)
+{
+    for (size_t k = 0; k < kinds.size(); k++) {
+        Kind& kind = kinds[k];
+        int count = kind.birth.size();
+        if (kind.style.newestFirst) {
+            for (int i = count - 1; i >= 0; i--) {
+                DrawObject(kind, i, flush, drawer);
+            }
+        }
+        else {
+            for (int i = 0; i < count; i++) {
+                DrawObject(kind, i, flush, drawer);
+            }
+        }
+    }
+    ofSetColor(255, 255, 255, 255);
+}
+
+void Highway::DrawObject(Kind& kind, int i, bool flush, BlockDrawer& drawer)
+{
+    ofPushMatrix();
+    ofTranslate(0, 0, kind.z[i]);
+    if (kind.mesh[i] < 0) {
+        ofSetColor(kind.lineColor[i]);
+        drawer.Draw(kind.block[i]);
+    }
+    else {
+        ofVboMesh& mesh = meshes[kind.mesh[i]];
+        if (flush && kind.style.fillColor.a > 0) {
+            ofEnableAlphaBlending();
+            ofSetColor(kind.fillColor[i]);
+            mesh.setMode(OF_PRIMITIVE_TRIANGLE_FAN);
+            mesh.draw();
+            ofDisableAlphaBlending();
+        }
+        ofSetColor(kind.lineColor[i]);
+        mesh.setMode(OF_PRIMITIVE_LINE_LOOP);
+        mesh.draw();
+    }
+    ofPopMatrix();
+}
@@ -0,0 +1,152 @@
+#ifndef HIGHWAY_H
+#define HIGHWAY_H
+
+#include <vector>
+
+#include "ofMain.h"
+
+/* How every object of one kind looks and moves. */
+struct HighwayStyle {
+    /* Outline color at birth. Objects fade to black as they age. */
+    ofColor lineColor = ofColor(255, 255, 255);
+
+    /* Fill color at birth, drawn behind the outline while the scene is
+     * flushed. Alpha 0 for outlines only. */
+    ofColor fillColor = ofColor(0, 0, 0, 0);
+
+    /* Seconds an object lives. */
+    float lifetime = 3.f;
+
+    /* Objects start at |startZ| and travel |travelZ| over their life. */
+    float startZ = 200.f;
+    float travelZ = -5000.f;
+
+    /* Draw the youngest objects first instead of the oldest. */
+    bool newestFirst = false;
+
+    /* Whether the ship can collide with objects of this kind. Only
+     * objects with an outline mesh can be solid. */
+    bool solid = false;
+};
+
+/* Objects flying down the audio highway.
+ *
+ * Objects are grouped by kind, and each kind keeps its objects' components
+ * in packed arrays: birth time, and the age, depth and color derived from
+ * it, plus a geometry handle. Update() runs the systems over the arrays
+ * once per frame (aging and placing in parallel chunks, then dropping
+ * expired objects in one pass) and Draw() only submits what Update()
+ * computed, however many outputs draw it. New kinds of object are a new
+ * style, not new loops. */
+class Highway
+{
+public:
+    Highway();
+
+    /* Declares a kind of object. Returns its id. */
+    int AddKind(const HighwayStyle& style);
+
+    /* The style of |kind|. Changes apply to its live objects from the next
+     * Update(). */
+    HighwayStyle& GetStyle(int kind);
+
+    /* Adds an object of |kind| born at |time|. Its geometry is |outline|
+     * (uploaded once, drawn as a line loop and a triangle fan fill), or if
+     * |outline| is empty, |block|, drawn by the block callback given to
+     * Draw(). */
+    void Spawn(int kind, const ofMesh& outline, float time, int block = -1);
+
+    /* Ages every object to |time| and drops the expired ones. */
+    void Update(float time);
+
+    /* Live objects of |kind|, or of every kind for -1. */
+    int GetNumObjects(int kind = -1);
+    int GetNumKinds();
+
+    /* Appends to |objects| the objects of |kind| whose bounds may reach
+     * into [|zMin|, |zMax|]. Objects of a kind stay sorted by depth as they
+     * age, so this is a binary search rather than a scan. */
+    void FindInDepthRange(int kind, float zMin, float zMax, std::vector<int>& objects);
+
+    /* World-space bounding box of an object. */
+    void GetBounds(int kind, int object, ofVec3f& min, ofVec3f& max);
+
+    /* Outline of an object with a mesh, in object space, and its depth. */
+    const ofMesh& GetOutline(int kind, int object);
+    float GetDepth(int kind, int object);
+
+    /* Marks an object as hit by the ship. Stays set for its lifetime. */
+    void SetHit(int kind, int object);
+    bool IsHit(int kind, int object);
+
+    /* Draws every object, kinds in the order they were added. Fills are
+     * only drawn if |flush|. Objects with a block are drawn by calling
+     * (object->*drawBlock)(block) with the object's depth and color set. */
+    template<class T>
+    void Draw(bool flush, T* object, void (T::*drawBlock)(int block));
+
+private:
+    struct BlockDrawer {
+        virtual ~BlockDrawer() {}
+        virtual void Draw(int block) = 0;
+    };
+
+    template<class T>
+    struct MethodBlockDrawer : public BlockDrawer {
+        T* object;
+        void (T::*method)(int);
+        void Draw(int block) { (object->*method)(block); }
+    };
+
+    /* Packed components of one kind's objects, oldest first. */
+    struct Kind {
+        HighwayStyle style;
+
+        /* Lifetime. */
+        std::vector<float> birth;
+
+        /* Derived by Update(): fraction of life used, depth and colors. */
+        std::vector<float> age;
+        std::vector<float> z;
+        std::vector<ofColor> lineColor;
+        std::vector<ofColor> fillColor;
+
+        /* Geometry: a pooled mesh, or -1 and a sample block. */
+        std::vector<int> mesh;
+        std::vector<int> block;
+
+        /* Collision: object-space bounds of the outline, and whether the
+         * ship hit the object. */
+        std::vector<ofVec3f> boundsMin;
+        std::vector<ofVec3f> boundsMax;
+        std::vector<char> hit;
+
+        /* Extent of every outline along z so far, for depth queries. */
+        bool hasOutlines = false;
+        float outlineZMin = 0.f;
+        float outlineZMax = 0.f;
+    };
+
+    void Draw(bool flush, BlockDrawer& drawer);
+    void DrawObject(Kind& kind, int i, bool flush, BlockDrawer& drawer);
+
+    /* Derives age, depth and colors of objects [begin, end) of |kind|. */
+    static void Place(Kind& kind, int begin, int end, float time);
+
+    std::vector<Kind> kinds;
+
+    /* Outline meshes of live objects, and the slots free for reuse. */
+    std::vector<ofVboMesh> meshes;
+    std::vector<int> freeMeshes;
+};
+
+template<class T>
+void Highway::Draw(bool flush, T* object, void (T::*drawBlock)(int block))
+{
+    MethodBlockDrawer<T> drawer;
+    drawer.object = object;
+    drawer.method = drawBlock;
+    Draw(flush, drawer);
+}
+
+#endif
@@ -0,0 +1,92 @@
+#include "hud.h"
+
+Hud::Hud()
+{
+    batch.setMode(OF_PRIMITIVE_TRIANGLES);
+    batch.setUsage(GL_DYNAMIC_DRAW);
+}
+
+void Hud::SetFont(ofTrueTypeFont* newFont)
+{
+    font = newFont;
+    for (size_t i = 0; i < lines.size(); i++) {
+        lines[i].changed = true;
+    }
+    changed = true;
+}
+
+int Hud::AddText(float x, float y, const std::string& text)
+{
+    Line line;
+    line.x = x;
+    line.y = y;
+    line.text = text;
+    lines.push_back(line);
+    changed = true;
+    return lines.size() - 1;
+}
+
+void Hud::SetText(int id, const std::string& text)
+{
+    Line& line = lines[id];
+    line.hasNumber = false;
+    if (line.text == text) {
+        return;
+    }
+    line.text = text;
+    line.changed = changed = true;
+}
+
+void Hud::SetNumber(int id, int value, const std::string& suffix)
+{
+    Line& line = lines[id];
+    if (line.hasNumber && line.number == value) {
+        return;
+    }
+    SetText(id, ofToString(value) + suffix);
+    line.hasNumber = true;
+    line.number = value;
+}
+
+void Hud::SetPosition(int id, float x, float y)
+{
+    Line& line = lines[id];
+    if (line.x == x && line.y == y) {
+        return;
+    }
+    line.x = x;
+    line.y = y;
+    line.changed = changed = true;
+}
+
+void Hud::Draw()
+{
+    if (!font || !font->isLoaded()) {
+        return;
+    }
+    if (changed) {
+        batch.clear();
+        for (size_t i = 0; i < lines.size(); i++) {
+            Line& line = lines[i];
+            if (line.changed) {
+                line.glyphs.clear();
+                if (!line.text.empty()) {
+                    line.glyphs = font->getStringMesh(line.text, line.x, line.y);
+                }
+                line.changed = false;
+            }
+            batch.append(line.glyphs);
+        }
+        changed = false;
+    }
+    if (batch.getNumVertices() == 0) {
+        return;
+    }
+
+    // Same state the font sets up for drawString().
+    ofEnableAlphaBlending();
+    font->getFontTexture().bind();
+    batch.draw();
+    font->getFontTexture().unbind();
+    ofDisableAlphaBlending();
+}
@@ -0,0 +1,64 @@
+#ifndef HUD_H
+#define HUD_H
+
+#include <string>
+#include <vector>
+
+#include "ofMain.h"
+
+/* Text overlay drawn in one batch.
+ *
+ * Each line of text keeps the glyph quads the font laid out for it, and
+ * only lays them out again when its text or position changes. Draw()
+ * joins the lines into one mesh, re-uploaded only after a change, and
+ * draws it with a single call from the font's glyph atlas. Static lines
+ * therefore cost nothing after the first frame, and live readouts only
+ * cost something on the frames their value changes. */
+class Hud
+{
+public:
+    Hud();
+
+    /* Uses |font| for every line. |font| must outlive the HUD. */
+    void SetFont(ofTrueTypeFont* font);
+
+    /* Adds a line with its baseline starting at (|x|, |y|). Returns its
+     * id. */
+    int AddText(float x, float y, const std::string& text = "");
+
+    /* Changes a line's text. Empty text hides the line. */
+    void SetText(int id, const std::string& text);
+
+    /* Shows |value| followed by |suffix|. Only formats the text when the
+     * value changes. */
+    void SetNumber(int id, int value, const std::string& suffix = "");
+
+    void SetPosition(int id, float x, float y);
+
+    /* Draws every line in the current color. */
+    void Draw();
+
+private:
+    struct Line {
+        float x;
+        float y;
+        std::string text;
+        
+        /* Last value passed to SetNumber(), to skip formatting. */
+        bool hasNumber = false;
+        int number = 0;
+        
+        /* Glyph quads of |text| at (|x|, |y|). */
+        ofMesh glyphs;
+        bool changed = true;
+    };
+
+    ofTrueTypeFont* font = NULL;
+    std::vector<Line> lines;
+
+    /* Every line's glyphs, rebuilt when any line changes. */
+    ofVboMesh batch;
+    bool changed = true;
+};
+
+#endif
@@ -0,0 +1,154 @@
+#include "level_meter.h"
+
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+LevelMeter::LevelMeter(long sampleRate, float rmsWindow)
+    : sampleRate(sampleRate)
+{
+    rmsLength = std::max(1L, (long)(rmsWindow * sampleRate));
+    squares = new float[rmsLength];
+    memset(squares, 0, rmsLength * sizeof(float));
+
+    loudnessLength = std::max(1L, (long)(0.4 * sampleRate));
+    weightedSquares = new float[loudnessLength];
+    memset(weightedSquares, 0, loudnessLength * sizeof(float));
+
+    // K-weighting filters from ITU-R BS.1770, with coefficients derived
+    // for the actual sample rate rather than the tabulated 48 kHz ones.
+    double K = tan(M_PI * 1681.974450955533 / sampleRate);
+    double Q = 0.7071752369554196;
+    double Vh = pow(10.0, 3.999843853973347 / 20.0);
+    double Vb = pow(Vh, 0.4996667741545416);
+    double a0 = 1.0 + K / Q + K * K;
+    shelfFilter = new_aubio_biquad((Vh + Vb * K / Q + K * K) / a0,
+                                   2.0 * (K * K - Vh) / a0,
+                                   (Vh - Vb * K / Q + K * K) / a0,
+                                   2.0 * (K * K - 1.0) / a0,
+                                   (1.0 - K / Q + K * K) / a0);
+
+    K = tan(M_PI * 38.13547087602444 / sampleRate);
+    Q = 0.5003270373238773;
+    a0 = 1.0 + K / Q + K * K;
+    highPassFilter = new_aubio_biquad(1.0, -2.0, 1.0,
+                                      2.0 * (K * K - 1.0) / a0,
+                                      (1.0 - K / Q + K * K) / a0);
+    weighted = new_fvec(weightedCapacity, 1);
+
+    SetEnvelopeTimes(0.01f, 0.3f);
+    SetPeakHold(1.f, 20.f);
+}
+
+LevelMeter::~LevelMeter()
+{
+    delete[] squares;
+    delete[] weightedSquares;
+    del_aubio_biquad(shelfFilter);
+    del_aubio_biquad(highPassFilter);
+    del_fvec(weighted);
+}
+
+void LevelMeter::SetEnvelopeTimes(float attack, float release)
+{
+    attackCoefficient = exp(-1.0 / (std::max(attack, 1e-4f) * sampleRate));
+    releaseCoefficient = exp(-1.0 / (std::max(release, 1e-4f) * sampleRate));
+}
+
+void LevelMeter::SetPeakHold(float hold, float decay)
+{
+    holdLength = (unsigned int)(hold * sampleRate);
+    peakDecay = pow(10.0, -decay / 20.0 / sampleRate);
+}
+
+void LevelMeter::Process(const float* samples, unsigned int numSamples)
+{
+    float envelope = current.envelope;
+    float peak = current.peak;
+
+    for (unsigned int i = 0; i < numSamples; i++) {
+        float x = samples[i];
+        float level = fabs(x);
+
+        // Sliding-window sum of squares.
+        float square = x * x;
+        rmsSum += square - squares[rmsPosition];
+        squares[rmsPosition] = square;
+        if (++rmsPosition == rmsLength) {
+            rmsPosition = 0;
+            rmsSum = 0.0;
+            for (unsigned int j = 0; j < rmsLength; j++) {
+                rmsSum += squares[j];
+            }
+        }
+
+        // Envelope follower.
+        float coefficient = (level > envelope) ? attackCoefficient : releaseCoefficient;
+        envelope = level + coefficient * (envelope - level);
+
+        // Peak hold.
+        if (level >= peak) {
+            peak = level;
+            holdCounter = holdLength;
+        }
+        else if (holdCounter > 0) {
+            holdCounter--;
+        }
+        else {
+            peak *= peakDecay;
+        }
+    }
+
+    // K-weight the block, a vector at a time, and slide the loudness window.
+    for (unsigned int offset = 0; offset < numSamples; offset += weightedCapacity) {
+        unsigned int count = std::min(weightedCapacity, numSamples - offset);
+        memcpy(weighted->data[0], samples + offset, count * sizeof(float));
+        weighted->length = count;
+        aubio_biquad_do(shelfFilter, weighted);
+        aubio_biquad_do(highPassFilter, weighted);
+
+        for (unsigned int i = 0; i < count; i++) {
+            float square = weighted->data[0][i] * weighted->data[0][i];
+            loudnessSum += square - weightedSquares[loudnessPosition];
+            weightedSquares[loudnessPosition] = square;
+            if (++loudnessPosition == loudnessLength) {
+                loudnessPosition = 0;
+                loudnessSum = 0.0;
+                for (unsigned int j = 0; j < loudnessLength; j++) {
+                    loudnessSum += weightedSquares[j];
+                }
+            }
+        }
+    }
+    weighted->length = weightedCapacity;
+
+    current.rms = sqrt(std::max(0.0, rmsSum / rmsLength));
+    current.peak = peak;
+    current.envelope = envelope;
+    double meanSquare = std::max(1e-10, loudnessSum / loudnessLength);
+    current.loudness = -0.691 + 10.0 * log10(meanSquare);
+    Publish();
+}
+
+void LevelMeter::Publish()
+{
+    sequence++;
+    __sync_synchronize();
+    published = current;
+    __sync_synchronize();
+    sequence++;
+}
+
+LevelReadings LevelMeter::GetReadings()
+{
+    LevelReadings readings;
+    unsigned int before, after;
+    do {
+        before = sequence;
+        __sync_synchronize();
+        readings = published;
+        __sync_synchronize();
+        after = sequence;
+    } while (before != after || (before & 1));
+    return readings;
+}
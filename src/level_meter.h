@@ -0,0 +1,85 @@
+#ifndef LEVEL_METER_H
+#define LEVEL_METER_H
+
+#include "aubio.h"
+
+/* A consistent snapshot of LevelMeter outputs. */
+struct LevelReadings {
+    /* True RMS over the meter window. */
+    float rms = 0.f;
+
+    /* Held peak of |x|, decaying after the hold time. */
+    float peak = 0.f;
+
+    /* Attack/release envelope of |x|. */
+    float envelope = 0.f;
+
+    /* Momentary loudness (K-weighted, 400 ms) in LUFS. */
+    float loudness = -70.f;
+};
+
+/* Streaming level meter. Process() is fed blocks of mono samples from a
+ * single (audio) thread and updates every reading in O(1) per sample;
+ * GetReadings() can be called from any thread without locking. */
+class LevelMeter
+{
+public:
+    /* |rmsWindow| is the RMS window length in seconds. */
+    LevelMeter(long sampleRate, float rmsWindow = 0.3f);
+    ~LevelMeter();
+
+    /* Sets the envelope follower's attack and release times in seconds. */
+    void SetEnvelopeTimes(float attack, float release);
+
+    /* Sets how long peaks are held, in seconds, and how fast they fall
+     * afterwards, in dB per second. */
+    void SetPeakHold(float hold, float decay);
+
+    /* Feeds a block of samples. Call from one thread only. */
+    void Process(const float* samples, unsigned int numSamples);
+
+    /* Gets the latest readings. Safe from any thread. */
+    LevelReadings GetReadings();
+
+private:
+    /* Publishes |current| to readers. */
+    void Publish();
+
+    long sampleRate;
+
+    /* Running sum of squares over a ring of the last |rmsLength| samples.
+     * The sum is recomputed exactly each time the ring wraps so rounding
+     * error can't accumulate. */
+    float* squares;
+    unsigned int rmsLength;
+    unsigned int rmsPosition = 0;
+    double rmsSum = 0.0;
+
+    /* Same, for K-weighted samples over the 400 ms loudness window. */
+    float* weightedSquares;
+    unsigned int loudnessLength;
+    unsigned int loudnessPosition = 0;
+    double loudnessSum = 0.0;
+
+    /* K-weighting pre-filter (high shelf) and RLB high-pass, and the
+     * scratch vector they run on. */
+    aubio_biquad_t* shelfFilter;
+    aubio_biquad_t* highPassFilter;
+    fvec_t* weighted;
+    unsigned int weightedCapacity = 512;
+
+    /* Envelope and peak state. */
+    float attackCoefficient;
+    float releaseCoefficient;
+    unsigned int holdLength;
+    unsigned int holdCounter = 0;
+    float peakDecay;
+
+    /* Readings, double-checked with a sequence counter: odd while a write
+     * is in progress. */
+    LevelReadings current;
+    LevelReadings published;
+    volatile unsigned int sequence = 0;
+};
+
+#endif
@@ -2,8 +2,107 @@
 #include "ofApp.h"
 #include "ofGLProgrammableRenderer.h"
 
-int main(void) {
+/* Prints the devices available through |api|. */
+void listDevices(RtAudio::Api api) {
+    AudioInput audio(44100, 1024);
+    audio.SetApi(api);
+    std::vector<RtAudio::DeviceInfo> devices = audio.GetDevices();
+    std::cout << "Devices for " << AudioInput::GetApiName(audio.GetApi()) << ":" << std::endl;
+    for (size_t i = 0; i < devices.size(); i++) {
+        if (!devices[i].probed) {
+            continue;
+        }
+        std::cout << "  " << i << ": " << devices[i].name
+                  << " (" << devices[i].inputChannels << " in)" << std::endl;
+    }
+}
+
+/* Reports an unknown -api value along with the names this build knows. */
+void printApiError(const std::string& name) {
+    std::vector<RtAudio::Api> apis = AudioInput::GetCompiledApis();
+    std::cerr << "Unknown audio API \"" << name << "\". Available:";
+    for (size_t i = 0; i < apis.size(); i++) {
+        std::cerr << " " << AudioInput::GetApiName(apis[i]);
+    }
+    std::cerr << std::endl;
+}
+
+/* Usage:
+ *   vroomvroom [-api alsa|jack|oss|core|dummy] [-device <name>]
+ *              [-port <jack port>] [-audio-offset <seconds>] [-list]
+ *              [-scale <fraction>|auto] [-minscale <fraction>] [-fps <rate>]
+ *              [-outputs <count>] [-overlap <pixels>]
+ *              [-capture <file.y4m>|<directory>] [-frames <count>] [-nodrop]
+ *              [-geometry cpu|gpu]
+ * e.g. "vroomvroom -api jack -port system:capture_1". A negative
+ * -audio-offset shows older audio, to line up with a delayed PA feed. */
+int main(int argc, char* argv[]) {
+    AudioSettings settings;
+    RenderSettings renderSettings;
+    CaptureSettings captureSettings;
+    bool list = false;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-api" && i + 1 < argc) {
+            settings.api = AudioInput::GetApiByName(argv[++i]);
+            if (settings.api == RtAudio::UNSPECIFIED) {
+                printApiError(argv[i]);
+                return 1;
+            }
+        }
+        else if (arg == "-device" && i + 1 < argc) {
+            settings.device = argv[++i];
+        }
+        else if (arg == "-port" && i + 1 < argc) {
+            settings.port = argv[++i];
+        }
+        else if (arg == "-audio-offset" && i + 1 < argc) {
+            settings.offset = ofToFloat(argv[++i]);
+        }
+        else if (arg == "-list") {
+            list = true;
+        }
+        else if (arg == "-scale" && i + 1 < argc) {
+            std::string scale = argv[++i];
+            if (scale == "auto") {
+                renderSettings.dynamic = true;
+            }
+            else {
+                renderSettings.scale = ofToFloat(scale);
+            }
+        }
+        else if (arg == "-minscale" && i + 1 < argc) {
+            renderSettings.minScale = ofToFloat(argv[++i]);
+        }
+        else if (arg == "-fps" && i + 1 < argc) {
+            renderSettings.targetFrameRate = ofToFloat(argv[++i]);
+        }
+        else if (arg == "-outputs" && i + 1 < argc) {
+            renderSettings.outputs = ofToInt(argv[++i]);
+        }
+        else if (arg == "-overlap" && i + 1 < argc) {
+            renderSettings.overlap = ofToFloat(argv[++i]);
+        }
+        else if (arg == "-capture" && i + 1 < argc) {
+            captureSettings.path = argv[++i];
+        }
+        else if (arg == "-frames" && i + 1 < argc) {
+            captureSettings.frames = ofToInt(argv[++i]);
+        }
+        else if (arg == "-nodrop") {
+            captureSettings.blocking = true;
+        }
+        else if (arg == "-geometry" && i + 1 < argc) {
+            renderSettings.gpuGeometry = (std::string(argv[++i]) != "cpu");
+        }
+    }
+    captureSettings.frameRate = renderSettings.targetFrameRate;
+    if (list) {
+        listDevices(settings.api);
+        return 0;
+    }
+    
     ofSetCurrentRenderer(ofGLProgrammableRenderer::TYPE);
 	ofSetupOpenGL(1024,768, OF_WINDOW);
-	ofRunApp(new ofApp(1024, 768));
+	ofRunApp(new ofApp(1024, 768, settings, renderSettings, captureSettings));
 }
@@ -1,14 +1,66 @@
 #include "ofApp.h"
 
-ofApp::ofApp(float width, float height)
-    : audio(44100, 1024), windowWidth(width), windowHeight(height) {
+/* Tunnel ring layout: sweep in radians, and displacement per unit of
+ * signal. Shared by the CPU and GPU geometry paths. */
+static const float kTunnelSweep = 2 * (M_PI - 0.01);
+static const float kTunnelGain = 100.f;
+
+/* Number of sample blocks kept for tunnel chunks drawn on the GPU. A block
+ * is pushed per chunk, every 10 frames, and chunks live for 3 seconds, so
+ * this covers them up to about 1700 fps. Beyond that chunks are skipped
+ * rather than drawn from a reused block. */
+static const int kSampleBlocks = 512;
+
+/* Scale of the ship model, and how long it flashes after hitting
+ * something, in seconds. */
+static const float kShipScale = 50.f;
+static const float kHitFlashTime = 0.2f;
+
+ofApp::ofApp(float width, float height, AudioSettings settings, RenderSettings renderSettings,
+             CaptureSettings captureSettings)
+    : audio(44100, 1024), windowWidth(width), windowHeight(height),
+      canvasWidth(width), canvasHeight(height),
+      spectrumBands(Filterbank::Mel, 128, 1024, audio.GetFrequencyResolution()),
+      captureSettings(captureSettings) {
+    // Select audio backend and input.
+    if (settings.api != RtAudio::UNSPECIFIED) {
+        audio.SetApi(settings.api);
+    }
+    if (!settings.port.empty()) {
+        audio.SetInputPort(settings.port);
+    }
+    else if (!settings.device.empty()) {
+        audio.SetInputDevice(settings.device);
+    }
     audio.Start();
+    audioOffset = settings.offset;
+    
+    // Pick the render resolution.
+    if (renderSettings.dynamic) {
+        renderScale.SetDynamic(renderSettings.targetFrameRate, renderSettings.minScale, renderSettings.scale);
+    }
+    else {
+        renderScale.SetFixedScale(renderSettings.scale);
+    }
+    
+    // Build audio geometry on the CPU or the GPU.
+    gpuGeometry = renderSettings.gpuGeometry;
+    
+    // Split the window between projectors.
+    numOutputs = std::max(renderSettings.outputs, 1);
+    outputOverlap = renderSettings.overlap;
 }
 
 ofApp::~ofApp() {
+    assets.Stop();
     audio.Stop();
 }
 
+void ofApp::exit() {
+    // Flush the recording while there's still a GL context to read from.
+    capture.Stop();
+}
+
 void ofApp::setup() {
     // Load and compile shaders
     horizontalBlurShader.load("blur.vert", "blurX.frag");
@@ -19,57 +71,98 @@ void ofApp::setup() {
     if (!verticalBlurShader.linkProgram()) {
         std::cerr << "Shaders not set up correctly!" << std::endl;
     }
-    
-    // Create new framebuffers
-    sceneBuffer.allocate(windowWidth, windowHeight, GL_RGBA);
-    firstPassBuffer.allocate(windowWidth, windowHeight, GL_RGBA);
-    secondPassBuffer.allocate(windowWidth, windowHeight, GL_RGBA);
-    if (!sceneBuffer.checkStatus() || !firstPassBuffer.checkStatus() || !secondPassBuffer.isAllocated()) {
-        std::cerr << "Framebuffers not set up correctly!" << std::endl;
+    upscaleShader.load("blur.vert", "upscale.frag");
+    if (!upscaleShader.linkProgram()) {
+        std::cerr << "Shaders not set up correctly!" << std::endl;
     }
     
-    // Load font
+    // Load font and lay out the HUD: frame rate, audio-to-display
+    // latency, render resolution, recording progress and instructions.
     font.loadFont("Tahoma.ttf", 18, true, true);
+    hud.SetFont(&font);
+    hudFrameRate = hud.AddText(10, 30);
+    hudLatency = hud.AddText(10, 55);
+    hudResolution = hud.AddText(10, 80);
+    hudRecording = hud.AddText(10, 105);
+    hudHits = hud.AddText(10, 130);
+    hudHelp = hud.AddText(windowWidth - 340, 30, "Press tab to change scenes.");
+    hudControls = hud.AddText(windowWidth / 2 - 160, windowHeight - 15);
+    
+    // Kinds of objects on the highway. Boxes are drawn newest first. The
+    // ship can run into road chunks and boxes, but flies through the
+    // tunnel.
+    HighwayStyle tunnel;
+    tunnelKind = highway.AddKind(tunnel);
+    HighwayStyle road;
+    road.lineColor = ofColor(0, 200, 255);
+    road.fillColor = ofColor(0, 200, 255, 20);
+    road.solid = true;
+    roadKind = highway.AddKind(road);
+    HighwayStyle box;
+    box.lineColor = ofColor(200, 200, 0);
+    box.fillColor = ofColor(255, 200, 0, 20);
+    box.newestFirst = true;
+    box.solid = true;
+    boxKind = highway.AddKind(box);
+    
+    // Blocks of raw samples for building geometry on the GPU.
+    if (gpuGeometry) {
+        audioGeometry.Setup(1024, kSampleBlocks);
+    }
+    
+    // Keep about half a minute of spectrum history at 60 fps.
+    bands.resize(spectrumBands.GetNumBands());
+    spectrogram.Setup(spectrumBands.GetNumBands(), 2048);
+    
+    // Set up the outputs, their render passes and buffers.
+    layoutOutputs();
     
     // Create ship.
-    ship = createShip();
-    modelPosition = ofVec3f(windowWidth / 2.f, windowHeight / 2.f + 200, 0.f);
-    keyUp = keyDown = keyLeft = keyRight = false;
-}
-
-ofMesh ofApp::createShip() {
-    // Load object file.
     ofxAssimpModelLoader model;
+    model.enableMeshCache();
     model.loadModel("ship.obj");
+    ship = createShip(model);
+    shipCollider.SetShape(model.getMeshView(0), kShipScale);
+    modelPosition = ofVec3f(canvasWidth / 2.f, canvasHeight / 2.f + 200, 0.f);
+    keyUp = keyDown = keyLeft = keyRight = false;
     
-    // Get mesh faces.
-    const std::vector<ofMeshFace>& faces(model.getMesh(0).getUniqueFaces());
-    ofMesh fixedMesh;
-    fixedMesh.setMode(OF_PRIMITIVE_LINES);
+    // Pick up edits to shaders and the ship without restarting.
+    assets.WatchShader(&horizontalBlurShader, "blur.vert", "blurX.frag");
+    assets.WatchShader(&verticalBlurShader, "blur.vert", "blurY.frag");
+    assets.WatchShader(&upscaleShader, "blur.vert", "upscale.frag");
+    assets.WatchModel("ship.obj");
+    assets.Start();
+    
+    // Start recording.
+    if (!captureSettings.path.empty()) {
+        capture.SetBlocking(captureSettings.blocking);
+        capture.Start(captureSettings.path, FrameCapture::GetFormatForPath(captureSettings.path),
+                      windowWidth, windowHeight, captureSettings.frameRate);
+    }
+}
+
+ofMesh ofApp::createShip(ofxAssimpModelLoader& model) {
+    // Indexed outline with each shared edge drawn once.
+    ofMesh fixedMesh = ofxAssimpWireframe::build(model.getMeshView(0));
 
     // Scale mesh.
-    for( int i = 0; i < faces.size(); i++ ) {
-        ofMeshFace face = faces[i];
-        fixedMesh.addVertex(50.f * face.getVertex(0));
-        fixedMesh.addVertex(50.f * face.getVertex(1));
-        fixedMesh.addVertex(50.f * face.getVertex(1));
-        fixedMesh.addVertex(50.f * face.getVertex(2));
-        fixedMesh.addVertex(50.f * face.getVertex(2));
-        fixedMesh.addVertex(50.f * face.getVertex(0));
+    vector<ofVec3f>& vertices = fixedMesh.getVertices();
+    for( size_t i = 0; i < vertices.size(); i++ ) {
+        vertices[i] *= kShipScale;
     }
     
     return fixedMesh;
 }
 
-ofAgingMesh ofApp::createBox(float *signal, size_t signalLength) {
-    ofAgingMesh mesh(3.0f);
+ofMesh ofApp::createBox(float *signal, size_t signalLength) {
+    ofMesh mesh;
     mesh.setMode(OF_PRIMITIVE_LINE_LOOP);
     
     float width = 200.f;
-    float radius = max(windowWidth / 2, windowHeight / 2) * audio.GetCurrentAmplitude() / 0.3f;
+    float radius = max(canvasWidth / 2, canvasHeight / 2) * audio.GetCurrentAmplitude() / 0.3f;
     float angle = ofRandom(0, M_PI) * audio.GetCurrentPitch() / (audio.GetFrequencyResolution() / 10.f);
-    float topX = windowWidth / 2 + radius * cos(angle) - width / 2.f;
-    float topY = windowHeight / 2 - radius * sin(angle) - width / 2.f;
+    float topX = canvasWidth / 2 + radius * cos(angle) - width / 2.f;
+    float topY = canvasHeight / 2 - radius * sin(angle) - width / 2.f;
     
     mesh.addVertex(ofVec3f(topX, topY, 0.f));
     mesh.addVertex(ofVec3f(topX + width, topY, 0.f));
@@ -79,16 +172,16 @@ ofAgingMesh ofApp::createBox(float *signal, size_t signalLength) {
     return mesh;
 }
 
-ofAgingMesh ofApp::createRoadChunk(float *signal, size_t signalLength) {
-    ofAgingMesh mesh(3.0f);
+ofMesh ofApp::createRoadChunk(float *signal, size_t signalLength) {
+    ofMesh mesh;
     mesh.setMode(OF_PRIMITIVE_LINE_LOOP);
     
-    float radius = max(windowWidth / 2, windowHeight / 2);
+    float radius = max(canvasWidth / 2, canvasHeight / 2);
     float offset = min(100.f, 200.f * audio.GetCurrentAmplitude());
-    float leftX = windowWidth / 2 + radius * cos(M_PI + 0.5);
-    float leftY = windowHeight / 2 - radius * sin(M_PI + 0.5) - offset;
-    float rightX = windowWidth / 2 + radius * cos(-0.5);
-    float rightY = windowHeight / 2 - radius * sin(-0.5) - offset;
+    float leftX = canvasWidth / 2 + radius * cos(M_PI + 0.5);
+    float leftY = canvasHeight / 2 - radius * sin(M_PI + 0.5) - offset;
+    float rightX = canvasWidth / 2 + radius * cos(-0.5);
+    float rightY = canvasHeight / 2 - radius * sin(-0.5) - offset;
     float width = 500.f;
     
     mesh.addVertex(ofVec3f(leftX, leftY, 0.f));
@@ -100,115 +193,114 @@ ofAgingMesh ofApp::createRoadChunk(float *signal, size_t signalLength) {
 }
 
 
-ofAgingMesh ofApp::createTunnelChunk(float* signal, size_t signalLength) {
-    ofAgingMesh mesh(3.0f);
+ofMesh ofApp::createTunnelChunk(float* signal, size_t signalLength) {
+    ofMesh mesh;
     mesh.setMode(OF_PRIMITIVE_LINE_LOOP);
+    if (gpuGeometry) {
+        // Drawn straight from the frame's sample block.
+        return mesh;
+    }
     
-    float radius = max(windowWidth / 1.5, windowHeight / 1.5);
+    // Directions and the undisplaced ring only change with the point count
+    // and the canvas size; the layout keeps them between chunks.
+    tunnelLayout.SetPoints(signalLength, kTunnelSweep);
+    tunnelLayout.SetCircle(canvasWidth / 2, canvasHeight / 2, getTunnelRadius());
     
-    float start = 50.f;
-    float end = windowWidth - 50.f;
-    float increment = (end - start) / signalLength;
-    for (size_t i = 0; i < signalLength; i++) {
-        float adjustedRadius = radius + 100 * signal[i];
-        float x = windowWidth / 2 + adjustedRadius * cos((float)i / signalLength * 2 * (M_PI - 0.01));
-        float y = windowHeight / 2 + adjustedRadius * sin((float)i / signalLength * 2 * (M_PI - 0.01));
-        float z = 0.f;
-        mesh.addVertex(ofVec3f(x, y, z));
-    }
+    mesh.getVertices().resize(signalLength);
+    tunnelLayout.Layout(signal, kTunnelGain, &mesh.getVertices()[0]);
     
     return mesh;
 }
 
-ofAgingMesh ofApp::createTimeDomainMesh(float* signal, size_t signalLength) {
-    ofAgingMesh mesh(3.0f);
-    mesh.setMode(OF_PRIMITIVE_LINE_STRIP);
-    
-    float start = 50.f;
-    float end = windowWidth - 50.f;
-    float increment = (end - start) / signalLength;
-    for (size_t i = 0; i < signalLength; i++) {
-        float x = start + i * increment;
-        float y = windowHeight / 4.f + 100.f * signal[i];
-        float z = 0.f;
-        mesh.addVertex(ofVec3f(x, y, z));
-    }
-    
-    return mesh;
+void ofApp::drawTunnelBlock(int block) {
+    audioGeometry.DrawRing(block, canvasWidth / 2, canvasHeight / 2, getTunnelRadius(), kTunnelGain, kTunnelSweep);
+}
+
+float ofApp::getTunnelRadius() {
+    return max(canvasWidth / 1.5, canvasHeight / 1.5);
 }
 
-ofAgingMesh ofApp::createFrequencySpectrumMesh(complex* spectrum, size_t spectrumSize) {
-    ofAgingMesh mesh(1.0f);
+ofAgingMesh ofApp::createTimeDomainMesh(float* signal, size_t signalLength) {
+    ofAgingMesh mesh(3.0f);
     mesh.setMode(OF_PRIMITIVE_LINE_STRIP);
     
-    float start = 50.f;
-    float end = windowWidth - 50.f;
-    float increment = (end - start) / spectrumSize;
-    for (size_t i = 0; i < spectrumSize; i++) {
-        float x = start + i * increment;
-        float y = 3 * windowHeight / 4.f - 200.f * ::pow(25 * cmp_abs(spectrum[i]), 0.5);
-        float z = 0.f;
-        mesh.addVertex(ofVec3f(x, y, z));
-    }
+    // Decimated to the min and max of each pixel once the signal is
+    // longer than the line is wide.
+    MakeWaveformPolyline(signal, signalLength, 50.f, canvasWidth - 50.f, canvasHeight / 4.f, 100.f,
+                         MinMaxDecimation, mesh);
     
     return mesh;
 }
 
 void ofApp::update() {
-    // Move older meshes back.
-    for (int i = 0; i < roadChunks.size(); i++) {
-        if (!roadChunks[i].isAlive()) {
-            roadChunks.erase(roadChunks.begin() + i--);
-        }
+    // Swap in reloaded assets before anything uses them this frame.
+    assets.Update();
+    ofxAssimpModelLoader* model = assets.GetReloadedModel("ship.obj");
+    if (model && model->getNumMeshes() > 0) {
+        ship = createShip(*model);
+        shipCollider.SetShape(model->getMeshView(0), kShipScale);
     }
-    for (int i = 0; i < boxes.size(); i++) {
-        if (!boxes[i].isAlive()) {
-            boxes.erase(boxes.begin() + i--);
-        }
-    }
-    for (int i = 0; i < tunnelChunks.size(); i++) {
-        if (!tunnelChunks[i].isAlive()) {
-            tunnelChunks.erase(tunnelChunks.begin() + i--);
-        }
-    }
-    for (int i = 0; i < frequencyMeshes.size(); i++) {
-        if (!frequencyMeshes[i].isAlive()) {
-            frequencyMeshes.erase(frequencyMeshes.begin() + i--);
-        }
+    
+    // Follow the frame time with the render resolution.
+    if (renderScale.Update(ofGetLastFrameTime())) {
+        allocateBuffers();
     }
-
+    
+    // Pick the audio that lines up with when this frame will be on screen.
+    // We assume it is presented one frame period from now.
+    double displayTime = AudioInput::GetHostTime() + ofGetLastFrameTime();
+    AudioTimestamp timestamp;
+    
     static int count = 0;
-    float* buffer = audio.GetCurrentInput();
+    float* buffer = audio.GetInputAt(displayTime + audioOffset, &timestamp);
+    audioLatency = displayTime - timestamp.hostTime;
     
-    // Create tunnel chunk.
+    // Create tunnel chunk. On the GPU it is drawn from its own block of
+    // samples, which has to stay put for as long as the chunk lives.
+    float time = ofGetElapsedTimef();
     if (count++ % 10 == 0) {
-        ofAgingMesh tunnelChunk = createTunnelChunk(buffer, 1024);
-        tunnelChunks.push_back(tunnelChunk);
+        if (!gpuGeometry) {
+            highway.Spawn(tunnelKind, createTunnelChunk(buffer, 1024), time);
+        }
+        else if (highway.GetNumObjects(tunnelKind) < kSampleBlocks) {
+            int block = audioGeometry.Push(buffer);
+            highway.Spawn(tunnelKind, createTunnelChunk(buffer, 1024), time, block);
+        }
     }
     
     // Create road chunk.
     if (count % 30 == 0) {
-        ofAgingMesh roadChunk = createRoadChunk(buffer, 1024);
-        roadChunks.push_back(roadChunk);
+        highway.Spawn(roadKind, createRoadChunk(buffer, 1024), time);
     }
     
     // Create box.
     if (count % 30 == 0) {
-        ofAgingMesh box = createBox(buffer, 1024);
-        boxes.push_back(box);
+        highway.Spawn(boxKind, createBox(buffer, 1024), time);
     }
     
+    // Cycle the tunnel's color, then move everything back and drop what
+    // reached the end of the highway.
+    float frequency = 0.01;
+    int frame = ofGetFrameNum();
+    highway.GetStyle(tunnelKind).lineColor = ofColor(sin(frequency * frame + 0) * 127 + 128,
+                                                     sin(frequency * frame + 2) * 127 + 128,
+                                                     sin(frequency * frame + 4) * 127 + 128);
+    highway.Update(time);
+    
     // Create timeMesh.
-    timeMesh = createTimeDomainMesh(buffer, 1024);
+    if (gpuGeometry) {
+        timeBlock = audioGeometry.SetCurrent(buffer);
+    }
+    else {
+        timeMesh = createTimeDomainMesh(buffer, 1024);
+    }
     delete[] buffer;
     
-    // Compute FFT. Add new frequency spectrum mesh.
-    if (count % 5 == 0) {
-        complex* frequencyBuffer = audio.GetTransformedInput();
-        ofAgingMesh frequencyMesh = createFrequencySpectrumMesh(frequencyBuffer, 1024);
-        frequencyMeshes.push_back(frequencyMesh);
-        delete[] frequencyBuffer;
-    }
+    // Compute FFT. Add the band magnitudes to the spectrum history.
+    complex* frequencyBuffer = audio.GetTransformedInputAt(displayTime + audioOffset);
+    spectrumBands.Process(frequencyBuffer, &bands[0]);
+    spectrogram.Push(&bands[0]);
+    delete[] frequencyBuffer;
     
     // Handle key presses.
     if (keyLeft) {
@@ -234,13 +326,151 @@ void ofApp::update() {
     modelRotation = modelRotation + ofGetLastFrameTime() * modelRotationalVelocity;
     
     // Perturb model position.
-    float time = ofGetElapsedTimef();
     modelPerturbation = ofVec3f(sin(2.f * time), cos(1.5f * time), 1.5 * sin(3.f * time));
+    
+    // Check the ship, where it will be drawn this frame, against the
+    // road and boxes. Each object only counts once.
+    if (sceneIndex == 1) {
+        shipCollider.SetTransform(modelPosition + 10.f * modelPerturbation, modelRotation.x);
+        collisions.clear();
+        shipCollider.Collide(highway, collisions);
+        if (!collisions.empty()) {
+            numHits += collisions.size();
+            lastHitTime = time;
+        }
+    }
+}
+
+void ofApp::layoutOutputs() {
+    outputs = LayoutOutputRow(numOutputs, windowWidth, windowHeight, outputOverlap, canvasWidth);
+    canvasHeight = windowHeight;
+    edgeBlends.clear();
+    for (size_t i = 0; i < outputs.size(); i++) {
+        edgeBlends.push_back(ofVboMesh(MakeEdgeBlendMesh(outputs[i])));
+    }
+    buildRenderGraph();
+    allocateBuffers();
+}
+
+void ofApp::allocateBuffers() {
+    // Outputs in a row are all the same size, so one set of buffers
+    // serves all of them.
+    float scale = renderScale.GetScale();
+    renderWidth = std::max(1, (int)(outputs[0].viewport.width * scale + 0.5f));
+    renderHeight = std::max(1, (int)(outputs[0].viewport.height * scale + 0.5f));
+    graph.SetSize(renderWidth, renderHeight);
+    
+    // Show the render resolution when it isn't native.
+    if (renderScale.IsDynamic() || renderWidth != (int)outputs[0].viewport.width) {
+        std::ostringstream resolution;
+        if (outputs.size() > 1) {
+            resolution << outputs.size() << " x ";
+        }
+        resolution << renderWidth << "x" << renderHeight;
+        hud.SetText(hudResolution, resolution.str());
+    }
+    else {
+        hud.SetText(hudResolution, "");
+    }
+}
+
+void ofApp::buildRenderGraph() {
+    graph.Clear();
+    passOutputs.clear();
+    
+    // Outputs are drawn one after another, so each output's targets are
+    // dead before the next output starts and they all share the same
+    // buffers.
+    for (size_t o = 0; o < outputs.size(); o++) {
+        // Draw the scene and show it.
+        int scene = graph.AddTarget("scene");
+        graph.AddPass("scene", -1, scene, this, &ofApp::scenePass);
+        graph.AddPass("present scene", scene, RenderGraph::Window, this, &ofApp::presentScenePass);
+        
+        // Blur it into a glow: 4 horizontal and 4 vertical passes to reduce
+        // banding artifacts. Each pass only lives until the next one has read
+        // it, so the chain runs in two buffers, the first being the scene's.
+        int source = scene;
+        for (int i = 0; i < 8; i++) {
+            int target = graph.AddTarget("glow");
+            if (i < 4) {
+                graph.AddPass("horizontal blur", source, target, this, &ofApp::horizontalBlurPass);
+            }
+            else {
+                graph.AddPass("vertical blur", source, target, this, &ofApp::verticalBlurPass);
+            }
+            source = target;
+        }
+        int last = graph.AddPass("present glow", source, RenderGraph::Window, this, &ofApp::presentGlowPass);
+        
+        // Fade out edges that overlap a neighbour.
+        if (edgeBlends[o].getNumVertices() > 0) {
+            last = graph.AddPass("edge blend", -1, RenderGraph::Window, this, &ofApp::edgeBlendPass);
+        }
+        passOutputs.resize(last + 1, o);
+    }
+}
+
+void ofApp::scenePass(RenderGraph& graph, int pass) {
+    // Lay the scene out for the whole canvas, then stretch the viewport so
+    // only this output's crop of it lands in the buffer. That keeps one
+    // camera for the whole wall, so the outputs line up at the seams.
+    const ofRectangle& crop = outputs[passOutputs[pass]].crop;
+    float scaleX = renderWidth / crop.width;
+    float scaleY = renderHeight / crop.height;
+    ofViewport(-crop.x * scaleX, -crop.y * scaleY, canvasWidth * scaleX, canvasHeight * scaleY);
+    ofSetupScreenPerspective(canvasWidth, canvasHeight);
+    drawScene(sceneIndex, true);
+}
+
+void ofApp::presentScenePass(RenderGraph& graph, int pass) {
+    drawToWindow(graph.GetTexture(graph.GetInput(pass, 0)), outputs[passOutputs[pass]].viewport);
+}
+
+void ofApp::horizontalBlurPass(RenderGraph& graph, int pass) {
+    blur(horizontalBlurShader, graph.GetTexture(graph.GetInput(pass, 0)));
+}
+
+void ofApp::verticalBlurPass(RenderGraph& graph, int pass) {
+    blur(verticalBlurShader, graph.GetTexture(graph.GetInput(pass, 0)));
+}
+
+void ofApp::presentGlowPass(RenderGraph& graph, int pass) {
+    ofEnableBlendMode(OF_BLENDMODE_ADD);
+    drawToWindow(graph.GetTexture(graph.GetInput(pass, 0)), outputs[passOutputs[pass]].viewport);
+    ofDisableBlendMode();
+}
+
+void ofApp::edgeBlendPass(RenderGraph& graph, int pass) {
+    ofEnableBlendMode(OF_BLENDMODE_MULTIPLY);
+    edgeBlends[passOutputs[pass]].draw();
+    ofDisableBlendMode();
+}
+
+void ofApp::blur(ofShader& shader, ofTexture& source) {
+    // Blur offsets are in buffer texels; scale them so the glow keeps
+    // its size on screen.
+    shader.begin();
+    shader.setUniform1f("blurAmnt", renderScale.GetScale());
+    ofBackground(0, 0, 0);
+    source.draw(0, 0, renderWidth, renderHeight);
+    shader.end();
+}
+
+void ofApp::drawToWindow(ofTexture& texture, const ofRectangle& viewport) {
+    bool upscale = renderWidth < viewport.width;
+    if (upscale) {
+        // Sharpen more the further we are from native resolution.
+        upscaleShader.begin();
+        upscaleShader.setUniform1f("sharpness", 1.f - renderScale.GetScale());
+    }
+    texture.draw(viewport.x, viewport.y, viewport.width, viewport.height);
+    if (upscale) {
+        upscaleShader.end();
+    }
 }
 
 void ofApp::drawScene(int sceneIndex, bool flush) {
-    sceneBuffer.begin();
-    
     // Enable depth testing.
     ofSetDepthTest(true);
     
@@ -252,150 +482,80 @@ void ofApp::drawScene(int sceneIndex, bool flush) {
         ofPushMatrix();
         ofTranslate(finalPosition.x, finalPosition.y, finalPosition.z);
         ofRotate(modelRotation.x, 0, 0, 1);
-        ofSetColor(255, 0, 255, 255);
-        ship.draw();
-        ofSetColor(255, 255, 255, 255);
-        ofPopMatrix();
-        
-        // Draw tunnel chunks.
-        static int count = 0;
-        float frequency = 0.01;
-        float red = sin(frequency * count + 0) * 127 + 128;
-        float green = sin(frequency * count + 2) * 127 + 128;
-        float blue = sin(frequency * count + 4) * 127 + 128;
-        ofColor tunnelColor(red, green, blue);
-        for (int i = 0; i < tunnelChunks.size(); i++) {
-            ofPushMatrix();
-            ofTranslate(0, 0, -5000.f * tunnelChunks[i].getAgePercent() + 200.f);
-            ofColor color = tunnelColor * (1.f - tunnelChunks[i].getAgePercent());
-            ofSetColor(color);
-            tunnelChunks[i].draw();
+        if (ofGetElapsedTimef() - lastHitTime < kHitFlashTime) {
             ofSetColor(255, 255, 255, 255);
-            ofPopMatrix();
         }
-        count++;
-        
-        // Draw road chunks.
-        for (int i = 0; i < roadChunks.size(); i++) {
-            ofPushMatrix();
-            ofTranslate(0, 0, -5000.f * roadChunks[i].getAgePercent() + 200.f);
-            if (flush) {
-                ofEnableAlphaBlending();
-                ofSetColor(0, 200.f * (1.f - roadChunks[i].getAgePercent()), 255.f * (1.f - roadChunks[i].getAgePercent()), 20);
-                roadChunks[i].setMode(OF_PRIMITIVE_TRIANGLE_FAN);
-                roadChunks[i].draw();
-                ofSetColor(255, 255, 255, 255);
-                ofDisableAlphaBlending();
-            }
-            ofSetColor(0, 200.f * (1.f - roadChunks[i].getAgePercent()), 255.f * (1.f - roadChunks[i].getAgePercent()), 255);
-            roadChunks[i].setMode(OF_PRIMITIVE_LINE_LOOP);
-            roadChunks[i].draw();
-            ofSetColor(255, 255, 255, 255);
-            ofPopMatrix();
+        else {
+            ofSetColor(255, 0, 255, 255);
         }
+        ship.draw();
+        ofSetColor(255, 255, 255, 255);
+        ofPopMatrix();
         
-        // Draw boxes.
-        for (int i = boxes.size() - 1; i >= 0; i--) {
-            ofPushMatrix();
-            ofTranslate(0, 0, -5000.f * boxes[i].getAgePercent() + 200.f);
-            if (flush) {
-                ofEnableAlphaBlending();
-                ofSetColor(255.f * (1.f - boxes[i].getAgePercent()), 200.f * (1.f - boxes[i].getAgePercent()), 0, 20);
-                boxes[i].setMode(OF_PRIMITIVE_TRIANGLE_FAN);
-                boxes[i].draw();
-                ofSetColor(255, 255, 255, 255);
-                ofDisableAlphaBlending();
-            }
-            ofSetColor(200.f * (1.f - boxes[i].getAgePercent()), 200.f * (1.f - boxes[i].getAgePercent()), 0, 255);
-            boxes[i].setMode(OF_PRIMITIVE_LINE_LOOP);
-            boxes[i].draw();
-            ofSetColor(255, 255, 255, 255);
-            ofPopMatrix();
-        }
+        // Draw tunnel chunks, road chunks and boxes.
+        highway.Draw(flush, this, &ofApp::drawTunnelBlock);
     }
     else {
         // Draw instantaneous sound signal.
         ofSetColor(0, 255, 0, 255);
-        timeMesh.draw();
+        if (gpuGeometry) {
+            if (timeBlock >= 0) {
+                audioGeometry.DrawWaveform(timeBlock, 50.f, canvasWidth - 50.f, canvasHeight / 4.f, 100.f);
+            }
+        }
+        else {
+            timeMesh.draw();
+        }
         ofSetColor(255, 255, 255, 255);
         
-        // Draw Fourier transformed signal.
-        for (int i = 0; i < frequencyMeshes.size(); i++) {
-            ofPushMatrix();
-            ofTranslate(0, 0, -500.f * (1.f - frequencyMeshes[i].getAgePercent()));
-            ofSetColor(0, 200.f * frequencyMeshes[i].getAgePercent(), 255.f * frequencyMeshes[i].getAgePercent(), 255);
-            frequencyMeshes[i].draw();
-            ofSetColor(255, 255, 255, 255);
-            ofPopMatrix();
+        // Draw Fourier transformed signal, either the last second of it
+        // flying towards the viewer or the whole history as a waterfall.
+        if (showWaterfall) {
+            spectrogram.DrawWaterfall(ofRectangle(50.f, canvasHeight / 2.f, canvasWidth - 100.f, canvasHeight / 2.f - 50.f));
+        }
+        else {
+            spectrogram.DrawHeightfield(50.f, canvasWidth - 50.f, 3 * canvasHeight / 4.f, 200.f, 500.f, 60);
         }
     }
     
     // Disable depth testing.
     ofSetDepthTest(false);
-    
-    sceneBuffer.end();
-    
-    // Draw contents of framebuffer to output.
-    if (flush) {
-        sceneBuffer.getTextureReference().draw(0, 0, windowWidth, windowHeight);
-    }
 }
 
-void ofApp::postProcessScene(bool flush) {
-    // Perform horizontal blur. We do 4 passes to reduce banding artifacts.
-    for (int i = 0; i < 4; i++) {
-        ofFbo& renderBuffer = (i % 2 == 0) ? firstPassBuffer : sceneBuffer;
-        ofFbo& textureBuffer = (i % 2 == 0) ? sceneBuffer : firstPassBuffer;
-        
-        // Perform horizontal blur.
-        renderBuffer.begin();
-        horizontalBlurShader.begin();
-        horizontalBlurShader.setUniform1f("blurAmnt", 1.f);
-        ofBackground(0, 0, 0);
-        textureBuffer.getTextureReference().draw(0, 0, windowWidth, windowHeight);
-        horizontalBlurShader.end();
-        renderBuffer.end();
-    }
-    
-    // Perform vertical blur. We do 4 passes to reduce banding artifacts.
-    for (int i = 0; i < 4; i++) {
-        ofFbo& renderBuffer = (i % 2 == 0) ? secondPassBuffer : sceneBuffer;
-        ofFbo& textureBuffer = (i % 2 == 0) ? sceneBuffer : secondPassBuffer;
-        
-        renderBuffer.begin();
-        verticalBlurShader.begin();
-        verticalBlurShader.setUniform1f("blurAmnt", 1.f);
-        ofBackground(0, 0, 0);
-        textureBuffer.getTextureReference().draw(0, 0, windowWidth, windowHeight);
-        verticalBlurShader.end();
-        renderBuffer.end();
+void ofApp::draw() {
+    // Draw scene and add glow.
+    graph.Execute();
+    
+    // Record the frame without the HUD.
+    if (capture.IsRecording()) {
+        capture.Capture(windowWidth, windowHeight);
+        if (captureSettings.frames > 0 && ++capturedFrames >= captureSettings.frames) {
+            ofExit();
+        }
     }
     
-    // Draw contents of framebuffer to output.
-    if (flush) {
-        sceneBuffer.getTextureReference().draw(0, 0, windowWidth, windowHeight);
+    // Update the readouts. Lines only get laid out again when their
+    // text changes.
+    hud.SetNumber(hudFrameRate, (int)(ofGetFrameRate() + 0.5f));
+    hud.SetNumber(hudLatency, (int)(1000.f * audioLatency), " ms");
+    if (capture.IsRecording()) {
+        std::string recording = "REC " + ofToString(capture.GetNumCaptured());
+        if (capture.GetNumDropped() > 0) {
+            recording += " (" + ofToString(capture.GetNumDropped()) + " dropped)";
+        }
+        hud.SetText(hudRecording, recording);
+    }
+    else {
+        hud.SetText(hudRecording, "");
     }
-}
-
-void ofApp::draw() {
-    // Draw scene.
-    drawScene(sceneIndex, true);
-    
-    // Add glow.
-    ofEnableBlendMode(OF_BLENDMODE_ADD);
-    postProcessScene(true);
-    ofDisableBlendMode();
-    
-    // Print framerate.
-    std::ostringstream buff;
-    buff << ofGetFrameRate();;
-    font.drawString(buff.str(), 10, 30);
-    
-    // Print instructions.
-    font.drawString("Press tab to change scenes.", windowWidth - 340, 30);
     if (sceneIndex == 1) {
-        font.drawString("Use arrow keys to fly around!", windowWidth / 2 - 160, windowHeight - 15);
+        hud.SetNumber(hudHits, numHits, (numHits == 1) ? " hit" : " hits");
+    }
+    else {
+        hud.SetText(hudHits, "");
     }
+    hud.SetText(hudControls, (sceneIndex == 1) ? "Use arrow keys to fly around!" : "");
+    hud.Draw();
 }
 
 void ofApp::keyPressed(int key) {
@@ -415,6 +575,9 @@ void ofApp::keyPressed(int key) {
         case OF_KEY_TAB:
             sceneIndex = (sceneIndex) ? 0 : 1;
             break;
+        case 'w':
+            showWaterfall = !showWaterfall;
+            break;
         default:
             break;
     }
@@ -442,4 +605,7 @@ void ofApp::keyReleased(int key) {
 void ofApp::windowResized(int w, int h) {
     windowWidth = w;
     windowHeight = h;
+    layoutOutputs();
+    hud.SetPosition(hudHelp, windowWidth - 340, 30);
+    hud.SetPosition(hudControls, windowWidth / 2 - 160, windowHeight - 15);
 }
@@ -3,18 +3,82 @@
 #include "ofMain.h"
 #include "ofAgingMesh.h"
 #include "addons/ofxAssimpModelLoader/src/ofxAssimpModelLoader.h"
+#include "addons/ofxAssimpModelLoader/src/ofxAssimpWireframe.h"
 
 #include "chuck_fft.h"
 #include "audio_input.h"
+#include "filterbank.h"
+#include "asset_watcher.h"
+#include "render_scale.h"
+#include "render_graph.h"
+#include "outputs.h"
+#include "frame_capture.h"
+#include "hud.h"
+#include "spectrogram.h"
+#include "polar_layout.h"
+#include "decimation.h"
+#include "audio_geometry.h"
+#include "highway.h"
+#include "ship_collider.h"
+
+/* Audio backend selection, filled in from the command line. */
+struct AudioSettings {
+    RtAudio::Api api = RtAudio::UNSPECIFIED;
+    std::string device;
+    std::string port;
+    
+    /* Seconds added to the display time when picking audio; see
+     * ofApp::audioOffset. */
+    double offset = 0.0;
+};
+
+/* Internal render resolution, filled in from the command line. */
+struct RenderSettings {
+    /* Fraction of the window size to render at. In dynamic mode, the
+     * largest scale used. */
+    float scale = 1.f;
+    
+    /* Lower the scale under load to hold |targetFrameRate|, down to
+     * |minScale|. */
+    bool dynamic = false;
+    float minScale = 0.5f;
+    float targetFrameRate = 60.f;
+    
+    /* Projector wall: number of side-by-side outputs the window is split
+     * into, and how many pixels neighbouring outputs overlap by. */
+    int outputs = 1;
+    float overlap = 0.f;
+    
+    /* Expand tunnel rings and the waveform from raw samples in a shader,
+     * rather than building their vertices on the CPU. */
+    bool gpuGeometry = true;
+};
+
+/* Recording, filled in from the command line. */
+struct CaptureSettings {
+    /* File (.y4m) or directory (PNG sequence) to record to, relative to
+     * the data folder. Empty to not record. */
+    std::string path;
+    float frameRate = 60.f;
+    
+    /* Quit after this many frames; 0 to record until the app is closed. */
+    int frames = 0;
+    
+    /* Slow down rather than drop frames when the disk can't keep up. */
+    bool blocking = false;
+};
 
 class ofApp: public ofBaseApp {
 public:
-    ofApp(float width, float height);
+    ofApp(float width, float height, AudioSettings settings = AudioSettings(),
+          RenderSettings renderSettings = RenderSettings(),
+          CaptureSettings captureSettings = CaptureSettings());
     ~ofApp();
     
     void setup();
     void update();
     void draw();
+    void exit();
 
     void keyPressed(int key);
     void keyReleased(int key);
@@ -25,59 +89,158 @@ private:
     int sceneIndex = 0;
     ofTrueTypeFont font;
     
-    /* Draws the scene without any post-processing effects. */
+    /* Text overlay and its lines. */
+    Hud hud;
+    int hudFrameRate;
+    int hudLatency;
+    int hudResolution;
+    int hudRecording;
+    int hudHits;
+    int hudHelp;
+    int hudControls;
+    
+    /* Draws the scene without any post-processing effects into the
+     * current render target. */
     void drawScene(int sceneIndex, bool flush);
     
-    /* Draws post-processing effects on top of the scene. */
-    void postProcessScene(bool flush);
+    /* Splits the window into outputs and sizes the canvas, buffers and
+     * render passes to match. */
+    void layoutOutputs();
+    
+    /* Declares the render passes for each output: the scene, the blur
+     * passes making up the glow, drawing both to the output's viewport and
+     * blending its edges. */
+    void buildRenderGraph();
+    
+    /* Render graph passes. */
+    void scenePass(RenderGraph& graph, int pass);
+    void presentScenePass(RenderGraph& graph, int pass);
+    void horizontalBlurPass(RenderGraph& graph, int pass);
+    void verticalBlurPass(RenderGraph& graph, int pass);
+    void presentGlowPass(RenderGraph& graph, int pass);
+    void edgeBlendPass(RenderGraph& graph, int pass);
+    
+    /* Draws |source| through a blur |shader| into the current target. */
+    void blur(ofShader& shader, ofTexture& source);
+    
+    /* Resizes the render targets to an output's size times the current
+     * render scale. */
+    void allocateBuffers();
     
-    /* Creates the ship. */
-    ofMesh createShip();
+    /* Draws |texture| over |viewport|, upscaling it if the render
+     * resolution is below the viewport's. */
+    void drawToWindow(ofTexture& texture, const ofRectangle& viewport);
+    
+    /* Creates the ship's wireframe from a loaded ship model. */
+    ofMesh createShip(ofxAssimpModelLoader& model);
     
     /* Creates a box on the audio highway. */
-    ofAgingMesh createBox(float* signal, size_t signalLength);
+    ofMesh createBox(float* signal, size_t signalLength);
     
     /* Creates a road chunk on the audio highway. */
-    ofAgingMesh createRoadChunk(float* signal, size_t signalLength);
+    ofMesh createRoadChunk(float* signal, size_t signalLength);
     
-    /* Creates a circular outline in the audio highway. */
-    ofAgingMesh createTunnelChunk(float* signal, size_t signalLength);
+    /* Creates a circular outline in the audio highway. With GPU geometry
+     * the mesh is empty; the chunk is drawn from its sample block by
+     * drawTunnelBlock(). */
+    ofMesh createTunnelChunk(float* signal, size_t signalLength);
+    void drawTunnelBlock(int block);
+    float getTunnelRadius();
     
     /* Creates a line strip mesh visualizing the instantaneous sound wave. */
     ofAgingMesh createTimeDomainMesh(float* signal, size_t signalLength);
     
-    /* Creates a line strip mesh visualizing the frequency spectrum of the
-     * instantenous sound wave. */
-    ofAgingMesh createFrequencySpectrumMesh(complex* spectrum, size_t spectrumSize);
-    
     /* Current window width, height. */
     float windowWidth;
     float windowHeight;
     
+    /* Size of the canvas the scene is laid out on. The same as the window
+     * for a single output; narrower by the overlaps for a projector wall. */
+    float canvasWidth;
+    float canvasHeight;
+    
+    /* Outputs the canvas is shown on, and the mask that blends each one's
+     * edges. */
+    int numOutputs = 1;
+    float outputOverlap = 0.f;
+    std::vector<Output> outputs;
+    std::vector<ofVboMesh> edgeBlends;
+    
     /* Audio input library. */
     AudioInput audio;
     
-    /* Blur shader and support variables. */
-    ofFbo sceneBuffer;
+    /* Groups FFT bins into mel bands for the spectrum display. */
+    Filterbank spectrumBands;
+    std::vector<float> bands;
+    
+    /* History of the spectrum bands, and whether scene 0 shows it as a
+     * flat waterfall instead of in 3D. */
+    Spectrogram spectrogram;
+    bool showWaterfall = false;
+    
+    /* Offset in seconds added to the predicted display time when picking
+     * audio. Negative values show older audio, e.g. to line up with a
+     * delayed PA feed. */
+    double audioOffset = 0.0;
+    
+    /* Age of the audio shown in the current frame at the time it reaches
+     * the screen, in seconds. */
+    float audioLatency = 0.f;
+    
+    /* Reloads the shaders and ship model when they are edited. */
+    AssetWatcher assets;
+    
+    /* Internal render resolution of each output: its size times the
+     * current render scale. */
+    RenderScaleController renderScale;
+    int renderWidth = 0;
+    int renderHeight = 0;
+    ofShader upscaleShader;
+    
+    /* Render passes and the buffers they draw into. Passes are repeated
+     * for each output; |passOutputs| maps a pass to its output. */
+    RenderGraph graph;
+    std::vector<int> passOutputs;
+    
+    /* Records the window, before the HUD is drawn. */
+    CaptureSettings captureSettings;
+    FrameCapture capture;
+    int capturedFrames = 0;
+    
+    /* Blur shaders. */
     ofShader horizontalBlurShader;
     ofShader verticalBlurShader;
-    ofFbo firstPassBuffer;
-    ofFbo secondPassBuffer;
-    ofMesh screen;
+    
+    /* Point directions of the tunnel rings. */
+    PolarLayout tunnelLayout;
+    
+    /* GPU geometry: recent sample blocks, and the block for the
+     * waveform. */
+    bool gpuGeometry = true;
+    AudioGeometry audioGeometry;
+    int timeBlock = -1;
     
     /* Ship model and location variables. */
-    ofMesh ship;
+    ofVboMesh ship;
     ofVec3f modelPosition;
     ofVec3f modelRotationalAcceleration;
     ofVec3f modelRotationalVelocity;
     ofVec3f modelRotation;
     ofVec3f modelPerturbation;
     
-    /* Vectors of all generated time domain meshes and frequency spectrum
-     * meshes. */
-    std::vector<ofAgingMesh> boxes;
-    std::vector<ofAgingMesh> roadChunks;
-    std::vector<ofAgingMesh> tunnelChunks;
+    /* Ship collisions with the road and boxes: the objects hit this frame,
+     * how many were hit in total and when the last one was. */
+    ShipCollider shipCollider;
+    std::vector<CollisionHit> collisions;
+    int numHits = 0;
+    float lastHitTime = -1.f;
+    
+    /* Tunnel chunks, road chunks and boxes on the audio highway. */
+    Highway highway;
+    int tunnelKind;
+    int roadKind;
+    int boxKind;
+    
+    /* The time domain mesh. */
     ofAgingMesh timeMesh;
-    std::vector<ofAgingMesh> frequencyMeshes;
 };
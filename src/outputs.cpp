@@ -0,0 +1,95 @@
+#include "outputs.h"
+
+#include <cmath>
+#include <algorithm>
+
+/* Segments across each blend ramp. */
+static const int kBlendSteps = 32;
+
+/* Steepness of the ramp's S-curve. 1 is linear; higher values keep more
+ * of the overlap at full or no brightness. */
+static const float kBlendPower = 2.f;
+
+/* Brightness at |t| from 0 (outer edge) to 1 (inner edge) of a ramp, in
+ * pixel values. The curve is symmetric about 0.5, so the two ramps of an
+ * overlap sum to one in light. */
+static float BlendRamp(float t, float gamma)
+{
+    float light = (t < 0.5f)
+        ? 0.5f * powf(2.f * t, kBlendPower)
+        : 1.f - 0.5f * powf(2.f * (1.f - t), kBlendPower);
+    return powf(light, 1.f / gamma);
+}
+
+/* Adds a ramp |length| long across a |breadth| wide strip starting at
+ * |origin|, fading in along |direction| and spanning |side|. */
+static void AddBlendStrip(ofMesh& mesh, ofVec3f origin, ofVec3f direction, ofVec3f side,
+                          float length, float breadth, float gamma)
+{
+    if (length <= 0.f) {
+        return;
+    }
+    for (int i = 0; i < kBlendSteps; i++) {
+        float t0 = (float)i / kBlendSteps;
+        float t1 = (float)(i + 1) / kBlendSteps;
+        ofFloatColor c0(BlendRamp(t0, gamma));
+        ofFloatColor c1(BlendRamp(t1, gamma));
+        ofVec3f a = origin + direction * (t0 * length);
+        ofVec3f b = origin + direction * (t1 * length);
+        
+        mesh.addVertex(a);                  mesh.addColor(c0);
+        mesh.addVertex(b);                  mesh.addColor(c1);
+        mesh.addVertex(b + side * breadth); mesh.addColor(c1);
+        mesh.addVertex(a);                  mesh.addColor(c0);
+        mesh.addVertex(b + side * breadth); mesh.addColor(c1);
+        mesh.addVertex(a + side * breadth); mesh.addColor(c0);
+    }
+}
+
+std::vector<Output> LayoutOutputRow(int count, float width, float height, float overlap,
+                                    float& canvasWidth)
+{
+    count = std::max(count, 1);
+    overlap = (count > 1) ? std::max(overlap, 0.f) : 0.f;
+    
+    // Each output gets an equal slice of the window. Its crop is as wide
+    // as its viewport, and consecutive crops step by that width less the
+    // overlap.
+    float outputWidth = width / count;
+    overlap = std::min(overlap, outputWidth / 2.f);
+    canvasWidth = width - (count - 1) * overlap;
+    
+    std::vector<Output> outputs(count);
+    for (int i = 0; i < count; i++) {
+        Output& output = outputs[i];
+        output.viewport = ofRectangle(i * outputWidth, 0.f, outputWidth, height);
+        output.crop = ofRectangle(i * (outputWidth - overlap), 0.f, outputWidth, height);
+        output.blendLeft = (i > 0) ? overlap : 0.f;
+        output.blendRight = (i < count - 1) ? overlap : 0.f;
+    }
+    return outputs;
+}
+
+ofMesh MakeEdgeBlendMesh(const Output& output)
+{
+    ofMesh mesh;
+    mesh.setMode(OF_PRIMITIVE_TRIANGLES);
+    
+    const ofRectangle& v = output.viewport;
+    float left = v.x;
+    float right = v.x + v.width;
+    float top = v.y;
+    float bottom = v.y + v.height;
+    
+    // Where two ramps cross at a corner the multiply blend takes the
+    // product, which is what the corner of the overlapping projector needs.
+    AddBlendStrip(mesh, ofVec3f(left, top), ofVec3f(1, 0), ofVec3f(0, 1),
+                  output.blendLeft, v.height, output.blendGamma);
+    AddBlendStrip(mesh, ofVec3f(right, top), ofVec3f(-1, 0), ofVec3f(0, 1),
+                  output.blendRight, v.height, output.blendGamma);
+    AddBlendStrip(mesh, ofVec3f(left, top), ofVec3f(0, 1), ofVec3f(1, 0),
+                  output.blendTop, v.width, output.blendGamma);
+    AddBlendStrip(mesh, ofVec3f(left, bottom), ofVec3f(0, -1), ofVec3f(1, 0),
+                  output.blendBottom, v.width, output.blendGamma);
+    return mesh;
+}
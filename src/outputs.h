@@ -0,0 +1,45 @@
+#ifndef OUTPUTS_H
+#define OUTPUTS_H
+
+#include <vector>
+
+#include "ofMain.h"
+
+/* One projector's share of a wall made of several. The scene is laid out
+ * once on a shared canvas; each output shows a crop of it in its own
+ * viewport, and fades out towards edges that overlap a neighbour so the
+ * overlaps don't show up brighter than the rest of the wall. */
+struct Output {
+    /* Where the output is drawn, in window pixels. */
+    ofRectangle viewport;
+    
+    /* Part of the canvas it shows, in canvas pixels. The crop is an
+     * off-axis slice of the shared camera, so neighbouring outputs line
+     * up exactly. */
+    ofRectangle crop;
+    
+    /* Width of the blend ramp along each edge of the viewport, in window
+     * pixels. 0 for edges that don't overlap another output. */
+    float blendLeft = 0.f;
+    float blendRight = 0.f;
+    float blendTop = 0.f;
+    float blendBottom = 0.f;
+    
+    /* Projector gamma. The ramp is corrected for it so that two
+     * overlapping ramps add up to full brightness in light, not in pixel
+     * values. */
+    float blendGamma = 2.2f;
+};
+
+/* Splits a |width| x |height| window into |count| side-by-side outputs.
+ * Neighbouring crops share |overlap| canvas pixels, which are blended
+ * across. Returns the outputs and sets |canvasWidth| to the width of the
+ * combined picture: the window width less the overlaps. */
+std::vector<Output> LayoutOutputRow(int count, float width, float height, float overlap,
+                                    float& canvasWidth);
+
+/* Builds a mask for |output|'s blended edges, in window coordinates, to be
+ * drawn over the output with multiply blending. Empty if no edge blends. */
+ofMesh MakeEdgeBlendMesh(const Output& output);
+
+#endif
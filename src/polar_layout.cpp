@@ -0,0 +1,85 @@
+#include "polar_layout.h"
+
+#include <cmath>
+
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+PolarLayout::PolarLayout()
+{
+}
+
+void PolarLayout::SetPoints(unsigned int newNumPoints, float newSweep)
+{
+    if (newNumPoints == numPoints && newSweep == sweep) {
+        return;
+    }
+    numPoints = newNumPoints;
+    sweep = newSweep;
+    directionX.resize(numPoints);
+    directionY.resize(numPoints);
+    for (unsigned int i = 0; i < numPoints; i++) {
+        float angle = (float)i / numPoints * sweep;
+        directionX[i] = cos(angle);
+        directionY[i] = sin(angle);
+    }
+    UpdateBase();
+}
+
+void PolarLayout::SetCircle(float x, float y, float newRadius)
+{
+    if (x == centerX && y == centerY && newRadius == radius) {
+        return;
+    }
+    centerX = x;
+    centerY = y;
+    radius = newRadius;
+    UpdateBase();
+}
+
+unsigned int PolarLayout::GetNumPoints()
+{
+    return numPoints;
+}
+
+void PolarLayout::UpdateBase()
+{
+    baseX.resize(numPoints);
+    baseY.resize(numPoints);
+    for (unsigned int i = 0; i < numPoints; i++) {
+        baseX[i] = centerX + radius * directionX[i];
+        baseY[i] = centerY + radius * directionY[i];
+    }
+}
+
+void PolarLayout::Layout(const float* signal, float gain, ofVec3f* vertices)
+{
+    float* output = (float*)vertices;
+    unsigned int i = 0;
+
+#if defined(__SSE__)
+    // Four points per iteration. The x and y lanes are interleaved with
+    // zeros into the 12 floats of four packed ofVec3f.
+    __m128 gains = _mm_set1_ps(gain);
+    __m128 zero = _mm_setzero_ps();
+    for (; i + 4 <= numPoints; i += 4) {
+        __m128 offset = _mm_mul_ps(gains, _mm_loadu_ps(signal + i));
+        __m128 x = _mm_add_ps(_mm_loadu_ps(&baseX[i]), _mm_mul_ps(offset, _mm_loadu_ps(&directionX[i])));
+        __m128 y = _mm_add_ps(_mm_loadu_ps(&baseY[i]), _mm_mul_ps(offset, _mm_loadu_ps(&directionY[i])));
+
+        __m128 low = _mm_unpacklo_ps(x, y);     // x0 y0 x1 y1
+        __m128 high = _mm_unpackhi_ps(x, y);    // x2 y2 x3 y3
+        __m128 x1 = _mm_shuffle_ps(zero, low, _MM_SHUFFLE(2, 2, 0, 0));
+        __m128 y1 = _mm_shuffle_ps(low, zero, _MM_SHUFFLE(0, 0, 3, 3));
+        __m128 xy3 = _mm_shuffle_ps(zero, high, _MM_SHUFFLE(3, 2, 0, 0));
+        _mm_storeu_ps(output + 3 * i, _mm_shuffle_ps(low, x1, _MM_SHUFFLE(2, 0, 1, 0)));
+        _mm_storeu_ps(output + 3 * i + 4, _mm_shuffle_ps(y1, high, _MM_SHUFFLE(1, 0, 2, 0)));
+        _mm_storeu_ps(output + 3 * i + 8, _mm_shuffle_ps(xy3, xy3, _MM_SHUFFLE(0, 3, 2, 0)));
+    }
+#endif
+    for (; i < numPoints; i++) {
+        float offset = gain * signal[i];
+        vertices[i].set(baseX[i] + offset * directionX[i], baseY[i] + offset * directionY[i], 0.f);
+    }
+}
@@ -0,0 +1,51 @@
+#ifndef POLAR_LAYOUT_H
+#define POLAR_LAYOUT_H
+
+#include <vector>
+
+#include "ofMain.h"
+
+/* Places points around a circle, pushed in or out by a signal.
+ *
+ * Point i sits at angle i / numPoints * sweep. The unit directions for
+ * every point and their positions on the undisplaced circle are computed
+ * once, when the point count or the circle changes, so laying out a ring
+ * is one multiply-add per coordinate: position = base + gain * signal *
+ * direction, four points at a time with SSE. */
+class PolarLayout
+{
+public:
+    PolarLayout();
+
+    /* Lays out |numPoints| points over |sweep| radians. Recomputes the
+     * directions only if either changed. */
+    void SetPoints(unsigned int numPoints, float sweep);
+
+    /* Centers the circle on (|x|, |y|) with radius |radius|. Recomputes
+     * the base positions only if the circle changed. */
+    void SetCircle(float x, float y, float radius);
+
+    unsigned int GetNumPoints();
+
+    /* Writes point i at radius + gain * signal[i] into |vertices|, with
+     * z = 0. Both arrays hold GetNumPoints() entries. */
+    void Layout(const float* signal, float gain, ofVec3f* vertices);
+
+private:
+    void UpdateBase();
+
+    unsigned int numPoints = 0;
+    float sweep = 0.f;
+    float centerX = 0.f;
+    float centerY = 0.f;
+    float radius = 0.f;
+
+    /* Unit direction and undisplaced position of each point, by
+     * coordinate. */
+    std::vector<float> directionX;
+    std::vector<float> directionY;
+    std::vector<float> baseX;
+    std::vector<float> baseY;
+};
+
+#endif
@@ -0,0 +1,203 @@
+#include "render_graph.h"
+
+#include <algorithm>
+
+RenderGraph::RenderGraph()
+{
+}
+
+RenderGraph::~RenderGraph()
+{
+    Clear();
+    ReleaseBuffers();
+}
+
+void RenderGraph::SetSize(int newWidth, int newHeight)
+{
+    if (newWidth == width && newHeight == height) {
+        return;
+    }
+    width = newWidth;
+    height = newHeight;
+    ReleaseBuffers();
+    compiled = false;
+}
+
+void RenderGraph::Clear()
+{
+    for (size_t i = 0; i < passes.size(); i++) {
+        delete passes[i].callback;
+    }
+    passes.clear();
+    targets.clear();
+    compiled = false;
+}
+
+int RenderGraph::AddTarget(const std::string& name, int internalFormat, float scale)
+{
+    Target target;
+    target.name = name;
+    target.internalFormat = internalFormat;
+    target.scale = scale;
+    target.buffer = -1;
+    targets.push_back(target);
+    compiled = false;
+    return targets.size() - 1;
+}
+
+int RenderGraph::AddPass(const std::string& name, const std::vector<int>& inputs, int output, Callback* callback)
+{
+    Pass pass;
+    pass.name = name;
+    pass.inputs = inputs;
+    pass.output = output;
+    pass.callback = callback;
+    passes.push_back(pass);
+    compiled = false;
+    return passes.size() - 1;
+}
+
+void RenderGraph::Compile()
+{
+    // Last pass that touches each target. After it, the target's buffer
+    // can be handed to another target.
+    std::vector<int> lastUse(targets.size(), -1);
+    for (size_t p = 0; p < passes.size(); p++) {
+        for (size_t i = 0; i < passes[p].inputs.size(); i++) {
+            lastUse[passes[p].inputs[i]] = p;
+        }
+        if (passes[p].output != Window) {
+            lastUse[passes[p].output] = p;
+        }
+    }
+
+    // Hand out buffers in pass order. A buffer is free for pass p once
+    // the target occupying it was last used before p.
+    std::vector<int> busyUntil(buffers.size(), -1);
+    std::vector<bool> used(buffers.size(), false);
+    for (size_t t = 0; t < targets.size(); t++) {
+        targets[t].buffer = -1;
+    }
+    for (size_t p = 0; p < passes.size(); p++) {
+        std::vector<int> touched = passes[p].inputs;
+        if (passes[p].output != Window) {
+            touched.push_back(passes[p].output);
+        }
+        for (size_t i = 0; i < touched.size(); i++) {
+            Target& target = targets[touched[i]];
+            if (target.buffer >= 0) {
+                continue;
+            }
+            if (passes[p].output != touched[i]) {
+                ofLogWarning("RenderGraph") << "pass \"" << passes[p].name << "\" reads \""
+                    << target.name << "\" before anything writes it";
+            }
+            int targetWidth = std::max(1, (int)(width * target.scale + 0.5f));
+            int targetHeight = std::max(1, (int)(height * target.scale + 0.5f));
+
+            int found = -1;
+            for (size_t b = 0; b < buffers.size() && found < 0; b++) {
+                if (busyUntil[b] < (int)p && buffers[b].width == targetWidth &&
+                    buffers[b].height == targetHeight &&
+                    buffers[b].internalFormat == target.internalFormat) {
+                    found = b;
+                }
+            }
+            if (found < 0) {
+                Buffer buffer;
+                buffer.fbo = new ofFbo();
+                buffer.fbo->allocate(targetWidth, targetHeight, target.internalFormat);
+                buffer.width = targetWidth;
+                buffer.height = targetHeight;
+                buffer.internalFormat = target.internalFormat;
+                if (!buffer.fbo->checkStatus()) {
+                    std::cerr << "Framebuffers not set up correctly!" << std::endl;
+                }
+                buffers.push_back(buffer);
+                busyUntil.push_back(-1);
+                used.push_back(false);
+                found = buffers.size() - 1;
+            }
+            target.buffer = found;
+            busyUntil[found] = lastUse[touched[i]];
+            used[found] = true;
+        }
+    }
+
+    // Drop buffers the current graph doesn't need.
+    std::vector<int> remap(buffers.size(), -1);
+    std::vector<Buffer> kept;
+    for (size_t b = 0; b < buffers.size(); b++) {
+        if (used[b]) {
+            remap[b] = kept.size();
+            kept.push_back(buffers[b]);
+        }
+        else {
+            delete buffers[b].fbo;
+        }
+    }
+    buffers.swap(kept);
+    for (size_t t = 0; t < targets.size(); t++) {
+        if (targets[t].buffer >= 0) {
+            targets[t].buffer = remap[targets[t].buffer];
+        }
+    }
+
+    ofLogVerbose("RenderGraph") << passes.size() << " passes, " << targets.size()
+        << " targets in " << buffers.size() << " buffers at " << width << "x" << height;
+    compiled = true;
+}
+
+void RenderGraph::ReleaseBuffers()
+{
+    for (size_t b = 0; b < buffers.size(); b++) {
+        delete buffers[b].fbo;
+    }
+    buffers.clear();
+    for (size_t t = 0; t < targets.size(); t++) {
+        targets[t].buffer = -1;
+    }
+}
+
+void RenderGraph::Execute()
+{
+    if (!compiled) {
+        Compile();
+    }
+    for (size_t p = 0; p < passes.size(); p++) {
+        Pass& pass = passes[p];
+        ofFbo* fbo = (pass.output != Window) ? buffers[targets[pass.output].buffer].fbo : NULL;
+        if (fbo) {
+            fbo->begin();
+        }
+        pass.callback->Run(*this, p);
+        if (fbo) {
+            fbo->end();
+        }
+    }
+}
+
+int RenderGraph::GetInput(int pass, int index)
+{
+    return passes[pass].inputs[index];
+}
+
+ofTexture& RenderGraph::GetTexture(int target)
+{
+    return buffers[targets[target].buffer].fbo->getTextureReference();
+}
+
+int RenderGraph::GetWidth(int target)
+{
+    return buffers[targets[target].buffer].width;
+}
+
+int RenderGraph::GetHeight(int target)
+{
+    return buffers[targets[target].buffer].height;
+}
+
+int RenderGraph::GetNumBuffers()
+{
+    return buffers.size();
+}
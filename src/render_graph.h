@@ -0,0 +1,139 @@
+#ifndef RENDER_GRAPH_H
+#define RENDER_GRAPH_H
+
+#include <string>
+#include <vector>
+
+#include "ofMain.h"
+
+/* A fixed sequence of render passes over transient render targets.
+ *
+ * Passes are declared once with the targets they read and the target they
+ * write. Targets are only names: when the graph is compiled, each one is
+ * backed by a pooled framebuffer, and targets whose lifetimes don't overlap
+ * share the same framebuffer. A chain of N blur passes therefore needs two
+ * buffers, not N. Framebuffers are pooled by size and format and are
+ * reallocated by SetSize() when the output size changes. */
+class RenderGraph
+{
+public:
+    /* Output of passes that draw straight to the window. */
+    static const int Window = -1;
+
+    RenderGraph();
+    ~RenderGraph();
+
+    /* Sets the size of full-size targets. Reallocates the pool if it
+     * changed. */
+    void SetSize(int width, int height);
+
+    /* Removes every pass and target. */
+    void Clear();
+
+    /* Declares a target |scale| times the graph size. */
+    int AddTarget(const std::string& name, int internalFormat = GL_RGBA, float scale = 1.f);
+
+    /* Declares a pass that reads |inputs| and draws into |output| (or the
+     * Window) by calling (object->*method)(graph, pass). Passes run in the
+     * order they are added. */
+    template<class T>
+    int AddPass(const std::string& name, const std::vector<int>& inputs, int output,
+                T* object, void (T::*method)(RenderGraph&, int));
+
+    /* Same, for passes with at most one input (-1 for none). */
+    template<class T>
+    int AddPass(const std::string& name, int input, int output,
+                T* object, void (T::*method)(RenderGraph&, int));
+
+    /* Runs every pass. Compiles the graph first if it changed. */
+    void Execute();
+
+    /* For use inside a pass: the pass's |index|th input, and a target's
+     * texture. */
+    int GetInput(int pass, int index);
+    ofTexture& GetTexture(int target);
+
+    /* Size of |target| in pixels. */
+    int GetWidth(int target);
+    int GetHeight(int target);
+
+    /* Framebuffers currently allocated for the graph. */
+    int GetNumBuffers();
+
+private:
+    struct Callback {
+        virtual ~Callback() {}
+        virtual void Run(RenderGraph& graph, int pass) = 0;
+    };
+
+    template<class T>
+    struct MethodCallback : public Callback {
+        T* object;
+        void (T::*method)(RenderGraph&, int);
+        void Run(RenderGraph& graph, int pass) { (object->*method)(graph, pass); }
+    };
+
+    struct Target {
+        std::string name;
+        int internalFormat;
+        float scale;
+
+        /* Set by Compile(). */
+        int buffer;
+    };
+
+    struct Pass {
+        std::string name;
+        std::vector<int> inputs;
+        int output;
+        Callback* callback;
+    };
+
+    struct Buffer {
+        ofFbo* fbo;
+        int width;
+        int height;
+        int internalFormat;
+    };
+
+    int AddPass(const std::string& name, const std::vector<int>& inputs, int output, Callback* callback);
+
+    /* Assigns a buffer to every target, creating buffers as needed. */
+    void Compile();
+    void ReleaseBuffers();
+
+    int width = 0;
+    int height = 0;
+    bool compiled = false;
+
+    std::vector<Target> targets;
+    std::vector<Pass> passes;
+    std::vector<Buffer> buffers;
+
+    /* Not copyable: owns its callbacks and framebuffers. */
+    RenderGraph(const RenderGraph&);
+    RenderGraph& operator=(const RenderGraph&);
+};
+
+template<class T>
+int RenderGraph::AddPass(const std::string& name, const std::vector<int>& inputs, int output,
+                         T* object, void (T::*method)(RenderGraph&, int))
+{
+    MethodCallback<T>* callback = new MethodCallback<T>();
+    callback->object = object;
+    callback->method = method;
+    return AddPass(name, inputs, output, callback);
+}
+
+template<class T>
+int RenderGraph::AddPass(const std::string& name, int input, int output,
+                         T* object, void (T::*method)(RenderGraph&, int))
+{
+    std::vector<int> inputs;
+    if (input >= 0) {
+        inputs.push_back(input);
+    }
+    return AddPass(name, inputs, output, object, method);
+}
+
+#endif
@@ -0,0 +1,98 @@
+#include "render_scale.h"
+
+#include <cmath>
+#include <algorithm>
+
+/* Scales are multiples of this. */
+static const float kScaleStep = 1.f / 16.f;
+
+/* Frames slower than target * kOverBudget shrink the scale; frames faster
+ * than target * kOnBudget count towards growing it again. The gap keeps
+ * vsync jitter from flipping the scale back and forth. */
+static const float kOverBudget = 1.15f;
+static const float kOnBudget = 1.05f;
+
+/* Seconds of on-budget frames before the scale grows by one step. */
+static const float kGrowDelay = 2.f;
+
+/* Frames ignored after a change. */
+static const int kCooldownFrames = 10;
+
+RenderScaleController::RenderScaleController()
+{
+}
+
+void RenderScaleController::SetFixedScale(float newScale)
+{
+    dynamic = false;
+    scale = std::min(std::max(Quantize(newScale), kScaleStep), 1.f);
+}
+
+void RenderScaleController::SetDynamic(float targetFrameRate, float newMinScale, float newMaxScale)
+{
+    dynamic = true;
+    targetFrameTime = 1.f / targetFrameRate;
+    minScale = std::max(Quantize(newMinScale), kScaleStep);
+    maxScale = std::max(Quantize(newMaxScale), minScale);
+    scale = maxScale;
+    averageFrameTime = 0.f;
+    timeOnBudget = 0.f;
+}
+
+bool RenderScaleController::IsDynamic()
+{
+    return dynamic;
+}
+
+bool RenderScaleController::Update(float frameTime)
+{
+    if (!dynamic || frameTime <= 0.f) {
+        return false;
+    }
+    if (cooldown > 0) {
+        cooldown--;
+        return false;
+    }
+    averageFrameTime = (averageFrameTime == 0.f)
+        ? frameTime
+        : averageFrameTime + 0.1f * (frameTime - averageFrameTime);
+
+    float next = scale;
+    if (averageFrameTime > targetFrameTime * kOverBudget) {
+        // Fill cost goes with the pixel count, i.e. the scale squared.
+        next = Quantize(scale * sqrtf(targetFrameTime / averageFrameTime));
+        if (next >= scale) {
+            next = scale - kScaleStep;
+        }
+        timeOnBudget = 0.f;
+    }
+    else if (averageFrameTime < targetFrameTime * kOnBudget) {
+        timeOnBudget += frameTime;
+        if (timeOnBudget > kGrowDelay) {
+            next = scale + kScaleStep;
+            timeOnBudget = 0.f;
+        }
+    }
+    else {
+        timeOnBudget = 0.f;
+    }
+
+    next = std::min(std::max(next, minScale), maxScale);
+    if (next == scale) {
+        return false;
+    }
+    scale = next;
+    averageFrameTime = 0.f;
+    cooldown = kCooldownFrames;
+    return true;
+}
+
+float RenderScaleController::GetScale()
+{
+    return scale;
+}
+
+float RenderScaleController::Quantize(float value)
+{
+    return roundf(value / kScaleStep) * kScaleStep;
+}
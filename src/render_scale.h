@@ -0,0 +1,46 @@
+#ifndef RENDER_SCALE_H
+#define RENDER_SCALE_H
+
+/* Picks the internal render resolution, as a fraction of the window size.
+ * In fixed mode the scale never changes. In dynamic mode the scale follows
+ * the measured frame time: it drops quickly when frames run over budget
+ * and creeps back up while they're on time. Scales are quantized so the
+ * render targets are only reallocated when the scale really moves. */
+class RenderScaleController
+{
+public:
+    RenderScaleController();
+
+    /* Uses a constant |scale| in (0, 1]. */
+    void SetFixedScale(float scale);
+
+    /* Adapts the scale between |minScale| and |maxScale| to hold
+     * |targetFrameRate|. */
+    void SetDynamic(float targetFrameRate, float minScale = 0.5f, float maxScale = 1.f);
+
+    bool IsDynamic();
+
+    /* Feeds the duration of the last frame in seconds. Returns true if
+     * the scale changed. */
+    bool Update(float frameTime);
+
+    float GetScale();
+
+private:
+    float Quantize(float scale);
+
+    bool dynamic = false;
+    float scale = 1.f;
+    float minScale = 0.5f;
+    float maxScale = 1.f;
+    float targetFrameTime = 1.f / 60.f;
+
+    /* Smoothed frame time, and how long frames have been on budget. */
+    float averageFrameTime = 0.f;
+    float timeOnBudget = 0.f;
+
+    /* Frames to ignore after a change, while the new size settles. */
+    int cooldown = 0;
+};
+
+#endif
@@ -0,0 +1,90 @@
+#include "resampler.h"
+
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+Resampler::Resampler(long inputRate, long outputRate, Quality quality)
+    : ratio((double)outputRate / inputRate)
+{
+    if (inputRate == outputRate) {
+        return;
+    }
+
+    if (!src_is_valid_ratio(ratio)) {
+        std::cout << "Unsupported resampling ratio " << ratio
+                  << ", analysis will run at the device rate." << std::endl;
+        ratio = 1.0;
+        return;
+    }
+
+    int error = 0;
+    state = src_new(quality, 1, &error);
+    if (!state) {
+        std::cout << "Could not create resampler: " << src_strerror(error) << std::endl;
+        ratio = 1.0;
+    }
+}
+
+Resampler::~Resampler()
+{
+    if (state) {
+        src_delete(state);
+    }
+}
+
+unsigned int Resampler::Process(const float* input, unsigned int numFrames, float* output)
+{
+    if (!state) {
+        memcpy(output, input, sizeof(float) * numFrames);
+        return numFrames;
+    }
+
+    // libsamplerate may stop early when it runs out of output room, so keep
+    // feeding it until the whole block has been consumed.
+    unsigned int capacity = GetMaxOutputFrames(numFrames);
+    unsigned int consumed = 0;
+    unsigned int produced = 0;
+    while (consumed < numFrames && produced < capacity) {
+        SRC_DATA data;
+        data.data_in = const_cast<float*>(input + consumed);
+        data.data_out = output + produced;
+        data.input_frames = numFrames - consumed;
+        data.output_frames = capacity - produced;
+        data.end_of_input = 0;
+        data.src_ratio = ratio;
+
+        if (src_process(state, &data) != 0) {
+            break;
+        }
+        if (data.input_frames_used == 0 && data.output_frames_gen == 0) {
+            break;
+        }
+        consumed += data.input_frames_used;
+        produced += data.output_frames_gen;
+    }
+    return produced;
+}
+
+void Resampler::Reset()
+{
+    if (state) {
+        src_reset(state);
+    }
+}
+
+unsigned int Resampler::GetMaxOutputFrames(unsigned int numFrames)
+{
+    // Leave a little slack for the fractional phase carried between blocks.
+    return (unsigned int)ceil(numFrames * ratio) + 4;
+}
+
+double Resampler::GetRatio()
+{
+    return ratio;
+}
+
+bool Resampler::IsPassthrough()
+{
+    return state == NULL;
+}
@@ -0,0 +1,50 @@
+#ifndef RESAMPLER_H
+#define RESAMPLER_H
+
+#include <cstddef>
+
+#include "samplerate.h"
+
+/* Streaming mono sample-rate converter built on libsamplerate. Filter
+ * state is kept between calls, so consecutive blocks resample into one
+ * continuous signal. */
+class Resampler
+{
+public:
+    /* Interpolator quality. Maps onto libsamplerate's sinc coefficient
+     * sets (fastest_coeffs.h / mid_qual_coeffs.h). */
+    enum Quality {
+        Fastest = SRC_SINC_FASTEST,
+        Medium = SRC_SINC_MEDIUM_QUALITY
+    };
+
+    /* Creates a converter from |inputRate| to |outputRate|. If the rates
+     * are equal, no libsamplerate state is created and Process() copies
+     * input straight to output. */
+    Resampler(long inputRate, long outputRate, Quality quality = Fastest);
+    ~Resampler();
+
+    /* Resamples |numFrames| input samples into |output|, which must hold
+     * at least GetMaxOutputFrames(numFrames) floats. Returns the number of
+     * samples written. Safe to call from the audio thread; no allocation. */
+    unsigned int Process(const float* input, unsigned int numFrames, float* output);
+
+    /* Clears filter history, e.g. after the stream was restarted. */
+    void Reset();
+
+    /* Upper bound on the number of samples Process() can produce for a
+     * block of |numFrames| input samples. */
+    unsigned int GetMaxOutputFrames(unsigned int numFrames);
+
+    /* Gets the output / input rate ratio. */
+    double GetRatio();
+
+    /* Returns true if input and output rates match. */
+    bool IsPassthrough();
+
+private:
+    double ratio;
+    SRC_STATE* state = NULL;
+};
+
+#endif
@@ -0,0 +1,9 @@
+#version 150
+
+uniform vec4 color;
+out vec4 outputColor;
+
+void main()
+{
+    outputColor = color;
+}
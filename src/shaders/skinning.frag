@@ -0,0 +1,20 @@
+#version 150
+
+uniform vec4 globalColor;
+uniform sampler2DRect src_tex_unit0;
+uniform float usingTexture;
+
+in vec3 normalVarying;
+in vec2 texCoordVarying;
+out vec4 outputColor;
+
+void main()
+{
+    // Simple head light so shape reads without scene lights.
+    float light = 0.3 + 0.7 * abs(normalize(normalVarying).z);
+    vec4 color = globalColor;
+    if (usingTexture > 0.5) {
+        color *= texture(src_tex_unit0, texCoordVarying);
+    }
+    outputColor = vec4(color.rgb * light, color.a);
+}
@@ -0,0 +1,9 @@
+#version 150
+
+in float age;
+out vec4 outputColor;
+
+void main()
+{
+    outputColor = vec4(0.0, 200.0 / 255.0 * age, age, 1.0);
+}
@@ -0,0 +1,172 @@
+#include "ship_collider.h"
+
+#include <cmath>
+#include <algorithm>
+
+/* Projects triangle |a| onto |axis|. */
+static void Project(const ofVec3f* a, const ofVec3f& axis, float& min, float& max)
+{
+    min = max = a[0].dot(axis);
+    for (int i = 1; i < 3; i++) {
+        float d = a[i].dot(axis);
+        min = std::min(min, d);
+        max = std::max(max, d);
+    }
+}
+
+/* Whether |axis| separates triangles |a| and |b|. Degenerate axes, from
+ * parallel edges, separate nothing. */
+static bool Separates(const ofVec3f* a, const ofVec3f* b, const ofVec3f& axis)
+{
+    if (axis.lengthSquared() < 1e-12f) {
+        return false;
+    }
+    float minA, maxA, minB, maxB;
+    Project(a, axis, minA, maxA);
+    Project(b, axis, minB, maxB);
+    return maxA < minB || maxB < minA;
+}
+
+/* Separating axis test for two triangles: both normals and every pair of
+ * edges, plus the in-plane edge normals for the coplanar case. */
+static bool TrianglesIntersect(const ofVec3f* a, const ofVec3f* b)
+{
+    ofVec3f edgesA[3] = { a[1] - a[0], a[2] - a[1], a[0] - a[2] };
+    ofVec3f edgesB[3] = { b[1] - b[0], b[2] - b[1], b[0] - b[2] };
+    ofVec3f normalA = edgesA[0].getCrossed(edgesA[1]);
+    ofVec3f normalB = edgesB[0].getCrossed(edgesB[1]);
+    if (Separates(a, b, normalA) || Separates(a, b, normalB)) {
+        return false;
+    }
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            if (Separates(a, b, edgesA[i].getCrossed(edgesB[j]))) {
+                return false;
+            }
+        }
+    }
+    if (normalA.getCrossed(normalB).lengthSquared() < 1e-12f) {
+        for (int i = 0; i < 3; i++) {
+            if (Separates(a, b, normalA.getCrossed(edgesA[i])) ||
+                Separates(a, b, normalB.getCrossed(edgesB[i]))) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+ShipCollider::ShipCollider()
+{
+}
+
+void ShipCollider::SetShape(const ofxAssimpMeshView& view, float scale)
+{
+    localTriangles.resize(3 * view.getNumTriangles());
+    radius = 0.f;
+    for (size_t t = 0; t < view.getNumTriangles(); t++) {
+        for (int c = 0; c < 3; c++) {
+            ofVec3f& vertex = localTriangles[3 * t + c];
+            vertex = view.getTriangleVertex(t, c) * scale;
+            radius = std::max(radius, vertex.length());
+        }
+    }
+    worldTriangles.resize(localTriangles.size());
+    triangleMin.resize(view.getNumTriangles());
+    triangleMax.resize(view.getNumTriangles());
+    worldValid = false;
+}
+
+void ShipCollider::SetTransform(const ofVec3f& newPosition, float newRotation)
+{
+    position = newPosition;
+    rotation = newRotation;
+    worldValid = false;
+}
+
+void ShipCollider::UpdateWorldTriangles()
+{
+    if (worldValid) {
+        return;
+    }
+    float radians = ofDegToRad(rotation);
+    float c = cosf(radians);
+    float s = sinf(radians);
+    for (size_t i = 0; i < localTriangles.size(); i++) {
+        const ofVec3f& v = localTriangles[i];
+        worldTriangles[i].set(position.x + c * v.x - s * v.y,
+                              position.y + s * v.x + c * v.y,
+                              position.z + v.z);
+    }
+    for (size_t t = 0; t < triangleMin.size(); t++) {
+        const ofVec3f* triangle = &worldTriangles[3 * t];
+        for (int axis = 0; axis < 3; axis++) {
+            triangleMin[t][axis] = std::min(triangle[0][axis], std::min(triangle[1][axis], triangle[2][axis]));
+            triangleMax[t][axis] = std::max(triangle[0][axis], std::max(triangle[1][axis], triangle[2][axis]));
+        }
+    }
+    worldValid = true;
+}
+
+void ShipCollider::Collide(Highway& highway, std::vector<CollisionHit>& hits)
+{
+    if (localTriangles.empty()) {
+        return;
+    }
+
+    // Whatever the rotation, the ship stays inside this box.
+    ofVec3f shipMin = position - ofVec3f(radius, radius, radius);
+    ofVec3f shipMax = position + ofVec3f(radius, radius, radius);
+
+    for (int kind = 0; kind < highway.GetNumKinds(); kind++) {
+        if (!highway.GetStyle(kind).solid) {
+            continue;
+        }
+        candidates.clear();
+        highway.FindInDepthRange(kind, shipMin.z, shipMax.z, candidates);
+        for (size_t i = 0; i < candidates.size(); i++) {
+            int object = candidates[i];
+            if (highway.IsHit(kind, object)) {
+                continue;
+            }
+            ofVec3f boundsMin, boundsMax;
+            highway.GetBounds(kind, object, boundsMin, boundsMax);
+            if (boundsMax.x < shipMin.x || boundsMin.x > shipMax.x ||
+                boundsMax.y < shipMin.y || boundsMin.y > shipMax.y ||
+                boundsMax.z < shipMin.z || boundsMin.z > shipMax.z) {
+                continue;
+            }
+            if (Intersects(highway, kind, object, boundsMin, boundsMax)) {
+                highway.SetHit(kind, object);
+                CollisionHit hit = { kind, object };
+                hits.push_back(hit);
+            }
+        }
+    }
+}
+
+bool ShipCollider::Intersects(Highway& highway, int kind, int object,
+                              const ofVec3f& boundsMin, const ofVec3f& boundsMax)
+{
+    UpdateWorldTriangles();
+
+    // Outlines are convex polygons; fan them into triangles.
+    const std::vector<ofVec3f>& outline = highway.GetOutline(kind, object).getVertices();
+    ofVec3f offset(0.f, 0.f, highway.GetDepth(kind, object));
+    for (size_t t = 0; t < triangleMin.size(); t++) {
+        const ofVec3f& min = triangleMin[t];
+        const ofVec3f& max = triangleMax[t];
+        if (max.x < boundsMin.x || min.x > boundsMax.x || max.y < boundsMin.y || min.y > boundsMax.y ||
+            max.z < boundsMin.z || min.z > boundsMax.z) {
+            continue;
+        }
+        const ofVec3f* triangle = &worldTriangles[3 * t];
+        for (size_t i = 1; i + 1 < outline.size(); i++) {
+            ofVec3f face[3] = { outline[0] + offset, outline[i] + offset, outline[i + 1] + offset };
+            if (TrianglesIntersect(triangle, face)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
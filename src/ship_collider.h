@@ -0,0 +1,67 @@
+#ifndef SHIP_COLLIDER_H
+#define SHIP_COLLIDER_H
+
+#include <vector>
+
+#include "ofMain.h"
+#include "addons/ofxAssimpModelLoader/src/ofxAssimpMeshView.h"
+#include "highway.h"
+
+/* A solid highway object the ship ran into. */
+struct CollisionHit {
+    int kind;
+    int object;
+};
+
+/* Detects the ship running into solid highway objects.
+ *
+ * The broad phase asks the highway for objects near the ship's depth,
+ * which is a binary search per kind since objects stay sorted by depth,
+ * then compares bounding boxes. Only the objects left are tested exactly,
+ * triangle against triangle, with the ship's triangles transformed once
+ * per frame and only if something got that far. */
+class ShipCollider
+{
+public:
+    ShipCollider();
+
+    /* Uses the triangles of |view|, scaled by |scale| as the ship model
+     * is. */
+    void SetShape(const ofxAssimpMeshView& view, float scale);
+
+    /* Places the ship as it is drawn: rotated |rotation| degrees about z,
+     * then moved to |position|. */
+    void SetTransform(const ofVec3f& position, float rotation);
+
+    /* Appends to |hits| the solid objects the ship intersects that it
+     * hadn't hit before, and marks them hit. */
+    void Collide(Highway& highway, std::vector<CollisionHit>& hits);
+
+private:
+    /* Transforms the ship's triangles, if not done since the last
+     * SetTransform(). */
+    void UpdateWorldTriangles();
+
+    /* Whether the ship intersects the outline of |object|. */
+    bool Intersects(Highway& highway, int kind, int object,
+                    const ofVec3f& boundsMin, const ofVec3f& boundsMax);
+
+    /* Ship triangles, three corners each, in model and world space, and
+     * the bounds of each world space triangle. */
+    std::vector<ofVec3f> localTriangles;
+    std::vector<ofVec3f> worldTriangles;
+    std::vector<ofVec3f> triangleMin;
+    std::vector<ofVec3f> triangleMax;
+    bool worldValid = false;
+
+    /* Radius of a sphere around the model's origin holding the ship. */
+    float radius = 0.f;
+
+    ofVec3f position;
+    float rotation = 0.f;
+
+    /* Scratch space for broad phase results. */
+    std::vector<int> candidates;
+};
+
+#endif
@@ -0,0 +1,102 @@
+#include "spectrogram.h"
+
+Spectrogram::Spectrogram()
+{
+}
+
+void Spectrogram::Setup(int newNumBands, int newLength)
+{
+    numBands = newNumBands;
+    length = newLength;
+    head = 0;
+
+    // Single-channel float rows, looked up with texelFetch() so no
+    // filtering runs across the ring's seam.
+    std::vector<float> silence(numBands * length, 0.f);
+    history.allocate(numBands, length, GL_R32F, false);
+    history.loadData(&silence[0], numBands, length, GL_RED);
+    history.setTextureMinMagFilter(GL_NEAREST, GL_NEAREST);
+
+    // Texture coordinates run over the whole history, top to bottom.
+    quad.clear();
+    quad.setMode(OF_PRIMITIVE_TRIANGLE_STRIP);
+    quad.addVertex(ofVec3f(0, 0));
+    quad.addTexCoord(ofVec2f(0, 0));
+    quad.addVertex(ofVec3f(1, 0));
+    quad.addTexCoord(ofVec2f(1, 0));
+    quad.addVertex(ofVec3f(0, 1));
+    quad.addTexCoord(ofVec2f(0, 1));
+    quad.addVertex(ofVec3f(1, 1));
+    quad.addTexCoord(ofVec2f(1, 1));
+
+    heightfieldShader.load("spectrogram.vert", "spectrogram.frag");
+    if (!heightfieldShader.linkProgram()) {
+        std::cerr << "Shaders not set up correctly!" << std::endl;
+    }
+    waterfallShader.load("blur.vert", "waterfall.frag");
+    if (!waterfallShader.linkProgram()) {
+        std::cerr << "Shaders not set up correctly!" << std::endl;
+    }
+}
+
+void Spectrogram::Push(const float* bands)
+{
+    head = (head + 1) % length;
+    glBindTexture(GL_TEXTURE_2D, history.getTextureData().textureID);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, head, numBands, 1, GL_RED, GL_FLOAT, bands);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+int Spectrogram::GetNumBands()
+{
+    return numBands;
+}
+
+int Spectrogram::GetLength()
+{
+    return length;
+}
+
+void Spectrogram::DrawHeightfield(float left, float right, float baseline, float height,
+                                  float depth, int rows)
+{
+    rows = std::min(std::max(rows, 1), length);
+    if (rows != gridRows) {
+        grid.clear();
+        grid.setMode(OF_PRIMITIVE_LINES);
+        for (int row = 0; row < rows; row++) {
+            for (int band = 0; band < numBands; band++) {
+                grid.addVertex(ofVec3f(band, row, 0.f));
+                if (band > 0) {
+                    grid.addIndex(row * numBands + band - 1);
+                    grid.addIndex(row * numBands + band);
+                }
+            }
+        }
+        gridRows = rows;
+    }
+
+    heightfieldShader.begin();
+    heightfieldShader.setUniformTexture("history", history, 0);
+    heightfieldShader.setUniform1i("head", head);
+    heightfieldShader.setUniform1i("rows", rows);
+    heightfieldShader.setUniform2f("span", left, right);
+    heightfieldShader.setUniform2f("baseline", baseline, height);
+    heightfieldShader.setUniform1f("depth", depth);
+    grid.draw();
+    heightfieldShader.end();
+}
+
+void Spectrogram::DrawWaterfall(const ofRectangle& area)
+{
+    waterfallShader.begin();
+    waterfallShader.setUniformTexture("history", history, 0);
+    waterfallShader.setUniform1i("head", head);
+    ofPushMatrix();
+    ofTranslate(area.x, area.y);
+    ofScale(area.width, area.height);
+    quad.draw();
+    ofPopMatrix();
+    waterfallShader.end();
+}
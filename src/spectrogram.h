@@ -0,0 +1,60 @@
+#ifndef SPECTROGRAM_H
+#define SPECTROGRAM_H
+
+#include <vector>
+
+#include "ofMain.h"
+
+/* History of band magnitudes kept on the GPU.
+ *
+ * Snapshots are rows of a float texture used as a ring: Push() uploads one
+ * row over the oldest one, so adding a snapshot costs the same however
+ * long the history is. Both views read the ring in a shader, the 3D
+ * heightfield from a fixed grid of vertices and the 2D waterfall from a
+ * single quad, so each is one draw call with no per-frame geometry. */
+class Spectrogram
+{
+public:
+    Spectrogram();
+
+    /* Allocates a history of |length| snapshots of |numBands| bands, all
+     * silent, and loads the shaders. Call from the GL thread. */
+    void Setup(int numBands, int length);
+
+    /* Adds a snapshot of GetNumBands() band magnitudes, as written by
+     * Filterbank::Process(). */
+    void Push(const float* bands);
+
+    int GetNumBands();
+    int GetLength();
+
+    /* Draws the latest |rows| snapshots as lines spanning |left| to
+     * |right|. A band rises |height| * sqrt(25 * magnitude) above
+     * |baseline|. The newest snapshot is |depth| back and brightens as it
+     * moves forward, like the separate spectrum meshes used to. */
+    void DrawHeightfield(float left, float right, float baseline, float height,
+                         float depth, int rows);
+
+    /* Draws the whole history as an image in |area|, newest at the top,
+     * low bands on the left. */
+    void DrawWaterfall(const ofRectangle& area);
+
+private:
+    int numBands = 0;
+    int length = 0;
+
+    /* Ring of snapshots, one per row, and the row written last. */
+    ofTexture history;
+    int head = 0;
+
+    /* One line strip per row, as GL_LINES, with vertices holding (band,
+     * row) for the shader to look up. Rebuilt when |rows| changes. */
+    ofVboMesh grid;
+    int gridRows = 0;
+
+    ofMesh quad;
+    ofShader heightfieldShader;
+    ofShader waterfallShader;
+};
+
+#endif
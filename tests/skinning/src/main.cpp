@@ -0,0 +1,27 @@
+#include "ofMain.h"
+#include "skinning_bench.h"
+#include "skinning_check.h"
+
+/* Usage:
+ *   skinning [bench] [bones] [meshes] [vertices] [frames]
+ *   skinning check [skinning.vert]
+ * "bench" times CPU skinning on a synthetic skeleton (defaults: 256 bones,
+ * 8 meshes of 20000 vertices, 200 frames). Build with and without
+ * PROJECT_CFLAGS = -fopenmp to compare the serial and parallel paths.
+ * "check" compares the GPU skinning shader's math with skinMesh(); the
+ * shader defaults to the app's, relative to this project. */
+int main(int argc, char* argv[]) {
+    std::string mode = (argc > 1) ? argv[1] : "bench";
+    if (mode == "bench") {
+        unsigned int bones = (argc > 2) ? ofToInt(argv[2]) : 256;
+        unsigned int meshes = (argc > 3) ? ofToInt(argv[3]) : 8;
+        unsigned int vertices = (argc > 4) ? ofToInt(argv[4]) : 20000;
+        int frames = (argc > 5) ? ofToInt(argv[5]) : 200;
+        return RunSkinningBench(bones, meshes, vertices, frames);
+    }
+    if (mode == "check") {
+        return RunSkinningCheck((argc > 2) ? argv[2] : "../../bin/data/skinning.vert");
+    }
+    std::cout << "Unknown mode \"" << mode << "\". Available: bench, check" << std::endl;
+    return 1;
+}
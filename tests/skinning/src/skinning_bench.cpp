@@ -0,0 +1,101 @@
+#include "skinning_bench.h"
+#include "synthetic_skeleton.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/* updateBones() before the skinning tables: finds every bone's node by
+ * name, walks its parent chain, and scatters weighted positions and
+ * normals bone by bone. Kept as the baseline to measure against. */
+static void SkinPerBone(const aiScene* scene, std::vector<ofxAssimpMeshHelper>& meshes)
+{
+    for (size_t i = 0; i < meshes.size(); i++) {
+        const aiMesh* mesh = meshes[i].mesh;
+        
+        std::vector<aiMatrix4x4> boneMatrices(mesh->mNumBones);
+        for (unsigned int a = 0; a < mesh->mNumBones; a++) {
+            const aiBone* bone = mesh->mBones[a];
+            const aiNode* node = scene->mRootNode->FindNode(bone->mName);
+            boneMatrices[a] = bone->mOffsetMatrix;
+            while (node) {
+                boneMatrices[a] = node->mTransformation * boneMatrices[a];
+                node = node->mParent;
+            }
+        }
+        
+        meshes[i].animatedPos.assign(meshes[i].animatedPos.size(), aiVector3D(0.f));
+        meshes[i].animatedNorm.assign(meshes[i].animatedNorm.size(), aiVector3D(0.f));
+        for (unsigned int a = 0; a < mesh->mNumBones; a++) {
+            const aiBone* bone = mesh->mBones[a];
+            const aiMatrix4x4& posTrafo = boneMatrices[a];
+            aiMatrix3x3 normTrafo(posTrafo);
+            for (unsigned int b = 0; b < bone->mNumWeights; b++) {
+                const aiVertexWeight& weight = bone->mWeights[b];
+                meshes[i].animatedPos[weight.mVertexId] += weight.mWeight * (posTrafo * mesh->mVertices[weight.mVertexId]);
+                meshes[i].animatedNorm[weight.mVertexId] += weight.mWeight * (normTrafo * mesh->mNormals[weight.mVertexId]);
+            }
+        }
+    }
+}
+
+/* Largest distance between the skinned positions of two runs. */
+static float MaxDifference(const std::vector<std::vector<aiVector3D> >& a,
+                           std::vector<ofxAssimpMeshHelper>& b)
+{
+    float worst = 0.f;
+    for (size_t i = 0; i < a.size(); i++) {
+        for (size_t v = 0; v < a[i].size(); v++) {
+            worst = std::max(worst, (a[i][v] - b[i].animatedPos[v]).Length());
+        }
+    }
+    return worst;
+}
+
+int RunSkinningBench(unsigned int numBones, unsigned int numMeshes,
+                     unsigned int numVertices, int frames)
+{
+    SyntheticSkeleton model(numBones, numMeshes, numVertices);
+    std::vector<ofxAssimpMeshHelper>& meshes = model.GetMeshes();
+    int threads = 1;
+#ifdef _OPENMP
+    threads = omp_get_max_threads();
+#endif
+    std::cout << model.GetNumBones() << " bones, " << numMeshes << " meshes of "
+              << numVertices << " vertices, " << frames << " frames, "
+              << threads << " thread(s)" << std::endl;
+    
+    // Both versions see the same poses; a few untimed frames first warm
+    // the caches and the OpenMP thread pool.
+    double perBone = 0.0;
+    double tables = 0.0;
+    float worst = 0.f;
+    std::vector<std::vector<aiVector3D> > reference(meshes.size());
+    for (int f = -5; f < frames; f++) {
+        model.Pose(f / 60.f);
+        
+        unsigned long long start = ofGetElapsedTimeMicros();
+        SkinPerBone(model.getAssimpScene(), meshes);
+        unsigned long long perBoneTime = ofGetElapsedTimeMicros() - start;
+        for (size_t i = 0; i < meshes.size(); i++) {
+            reference[i] = meshes[i].animatedPos;
+        }
+        
+        start = ofGetElapsedTimeMicros();
+        model.Skin();
+        unsigned long long tablesTime = ofGetElapsedTimeMicros() - start;
+        
+        if (f >= 0) {
+            perBone += perBoneTime / 1000.0;
+            tables += tablesTime / 1000.0;
+            worst = std::max(worst, MaxDifference(reference, meshes));
+        }
+    }
+    
+    frames = std::max(frames, 1);
+    std::cout << "  per-bone search and scatter: " << perBone / frames << " ms/frame" << std::endl;
+    std::cout << "  skinning tables (updateBones): " << tables / frames << " ms/frame" << std::endl;
+    std::cout << "  speedup: " << perBone / std::max(tables, 1e-6) << "x" << std::endl;
+    std::cout << "  largest position difference: " << worst << std::endl;
+    return 0;
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+/* Times updateBones() against the per-bone skinning it replaced, on a
+ * synthetic skeleton, and prints milliseconds per frame for both.
+ * Returns the process exit code. */
+int RunSkinningBench(unsigned int numBones, unsigned int numMeshes,
+                     unsigned int numVertices, int frames);
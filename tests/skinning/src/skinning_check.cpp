@@ -0,0 +1,145 @@
+#include "skinning_check.h"
+#include "synthetic_skeleton.h"
+
+#include <fstream>
+
+/* Largest difference allowed between the two, relative to the size of
+ * the result. Both sum the same products in float, in different orders. */
+static const float kTolerance = 1e-4f;
+
+/* A GLSL mat4: four columns of four floats. */
+struct ShaderMatrix {
+    float column[4][4];
+};
+
+/* The palette as the shader sees it. The loader uploads aiMatrix4x4s,
+ * which are row-major, with glUniformMatrix4fv(..., GL_TRUE, ...). */
+static ShaderMatrix UploadBone(const aiMatrix4x4& bone)
+{
+    const float* rows = &bone.a1;
+    ShaderMatrix matrix;
+    for (int c = 0; c < 4; c++) {
+        for (int r = 0; r < 4; r++) {
+            matrix.column[c][r] = rows[4 * r + c];
+        }
+    }
+    return matrix;
+}
+
+/* skinning.vert's main() for a skinned vertex, without the view and
+ * projection. |boneIndices| are float attributes, so they're truncated
+ * like int() in GLSL. Returns false if an index is outside the palette. */
+static bool ShaderSkin(const std::vector<ShaderMatrix>& bones, const float* boneIndices,
+                       const float* boneWeights, const aiVector3D& position,
+                       const aiVector3D& normal, aiVector3D& skinnedPosition,
+                       aiVector3D& skinnedNormal)
+{
+    // mat4 skin = boneWeights.x * bones[int(boneIndices.x)] + ...
+    ShaderMatrix skin;
+    memset(&skin, 0, sizeof(skin));
+    for (int k = 0; k < 4; k++) {
+        int index = (int)boneIndices[k];
+        if (index < 0 || index >= (int)bones.size()) {
+            return false;
+        }
+        for (int c = 0; c < 4; c++) {
+            for (int r = 0; r < 4; r++) {
+                skin.column[c][r] += boneWeights[k] * bones[index].column[c][r];
+            }
+        }
+    }
+    
+    // skin * vec4(position.xyz, 1.0) and mat3(skin) * normal.xyz.
+    float p[4] = { position.x, position.y, position.z, 1.f };
+    float n[3] = { normal.x, normal.y, normal.z };
+    float outPosition[3] = { 0.f, 0.f, 0.f };
+    float outNormal[3] = { 0.f, 0.f, 0.f };
+    for (int r = 0; r < 3; r++) {
+        for (int c = 0; c < 4; c++) {
+            outPosition[r] += skin.column[c][r] * p[c];
+        }
+        for (int c = 0; c < 3; c++) {
+            outNormal[r] += skin.column[c][r] * n[c];
+        }
+    }
+    skinnedPosition.Set(outPosition[0], outPosition[1], outPosition[2]);
+    skinnedNormal.Set(outNormal[0], outNormal[1], outNormal[2]);
+    return true;
+}
+
+/* Difference between |a| and the reference |b|, relative to |b|'s size
+ * once that is above 1. */
+static float RelativeError(const aiVector3D& a, const aiVector3D& b)
+{
+    return (a - b).Length() / std::max(1.f, b.Length());
+}
+
+/* Reads the value of "#define MAX_BONES" from the shader, or -1. */
+static int ReadMaxBones(const std::string& shaderPath)
+{
+    std::ifstream shader(shaderPath.c_str());
+    std::string line;
+    while (std::getline(shader, line)) {
+        std::istringstream words(line);
+        std::string define, name;
+        int value;
+        if (words >> define >> name >> value && define == "#define" && name == "MAX_BONES") {
+            return value;
+        }
+    }
+    return -1;
+}
+
+int RunSkinningCheck(const std::string& shaderPath)
+{
+    bool ok = true;
+    int maxBones = ReadMaxBones(shaderPath);
+    if (maxBones != OFX_ASSIMP_MAX_GPU_BONES) {
+        std::cout << "MAX_BONES in " << shaderPath << " is " << maxBones
+                  << ", the loader allows " << OFX_ASSIMP_MAX_GPU_BONES << std::endl;
+        ok = false;
+    }
+    
+    // As many bones as the shader takes, so every palette slot is used.
+    SyntheticSkeleton model(OFX_ASSIMP_MAX_GPU_BONES, 2, 5000);
+    std::vector<ofxAssimpMeshHelper>& meshes = model.GetMeshes();
+    float worstPosition = 0.f;
+    float worstNormal = 0.f;
+    int badIndices = 0;
+    for (int pose = 0; pose < 10; pose++) {
+        model.Pose(pose * 0.37f);
+        model.Skin();
+        for (size_t i = 0; i < meshes.size(); i++) {
+            ofxAssimpMeshHelper& meshHelper = meshes[i];
+            const aiMesh* mesh = meshHelper.mesh;
+            
+            // The attributes as uploadSkinningAttributes() sends them.
+            std::vector<float> boneIndices(meshHelper.boneIndices.begin(), meshHelper.boneIndices.end());
+            const std::vector<float>& boneWeights = meshHelper.boneWeights;
+            std::vector<ShaderMatrix> bones;
+            for (size_t b = 0; b < meshHelper.boneMatrices.size(); b++) {
+                bones.push_back(UploadBone(meshHelper.boneMatrices[b]));
+            }
+            
+            for (unsigned int v = 0; v < mesh->mNumVertices; v++) {
+                aiVector3D position, normal;
+                if (!ShaderSkin(bones, &boneIndices[4 * v], &boneWeights[4 * v],
+                                mesh->mVertices[v], mesh->mNormals[v], position, normal)) {
+                    badIndices++;
+                    continue;
+                }
+                worstPosition = std::max(worstPosition, RelativeError(position, meshHelper.animatedPos[v]));
+                worstNormal = std::max(worstNormal, RelativeError(normal, meshHelper.animatedNorm[v]));
+            }
+        }
+    }
+    
+    std::cout << "largest position difference: " << worstPosition << std::endl;
+    std::cout << "largest normal difference: " << worstNormal << std::endl;
+    if (badIndices > 0) {
+        std::cout << badIndices << " vertices index past the bone palette" << std::endl;
+    }
+    ok = ok && badIndices == 0 && worstPosition <= kTolerance && worstNormal <= kTolerance;
+    std::cout << (ok ? "ok" : "FAILED") << std::endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+#include <string>
+
+/* Checks that skinning.vert, fed the attributes and bone palette the
+ * model loader uploads, places vertices where skinMesh() does. Also checks
+ * that the shader's MAX_BONES matches OFX_ASSIMP_MAX_GPU_BONES. Prints the
+ * largest differences and returns the process exit code. */
+int RunSkinningCheck(const std::string& shaderPath);
@@ -0,0 +1,133 @@
+#include "synthetic_skeleton.h"
+
+/* Length of each bone, and the weights of a vertex's influences before
+ * they are normalized. */
+static const float kBoneLength = 10.f;
+static const float kWeights[4] = { 0.4f, 0.3f, 0.2f, 0.1f };
+
+/* Vertices have 1 to 4 influences, so partly filled weight tables are
+ * covered too. */
+static int GetNumInfluences(unsigned int vertex)
+{
+    return 1 + vertex % 4;
+}
+
+SyntheticSkeleton::SyntheticSkeleton(unsigned int numBones, unsigned int numMeshes,
+                                     unsigned int numVertices)
+{
+    numBones = std::max(numBones, 4u);
+    aiScene* built = new aiScene();
+    built->mRootNode = new aiNode("root");
+    
+    // Bone i hangs off bone (i - 1) / 2, or the root for the first one.
+    std::vector<std::vector<aiNode*> > children(numBones + 1);
+    for (unsigned int i = 0; i < numBones; i++) {
+        bones.push_back(new aiNode("bone" + ofToString(i)));
+        parents.push_back(i == 0 ? -1 : (int)(i - 1) / 2);
+        aiNode* parent = (i == 0) ? built->mRootNode : bones[parents[i]];
+        bones[i]->mParent = parent;
+        children[i == 0 ? numBones : parents[i]].push_back(bones[i]);
+    }
+    for (unsigned int i = 0; i <= numBones; i++) {
+        aiNode* node = (i == numBones) ? built->mRootNode : bones[i];
+        node->mNumChildren = children[i].size();
+        if (!children[i].empty()) {
+            node->mChildren = new aiNode*[children[i].size()];
+            std::copy(children[i].begin(), children[i].end(), node->mChildren);
+        }
+    }
+    
+    // Offset matrices undo each bone's global transform in the bind pose.
+    Pose(0.f);
+    std::vector<aiMatrix4x4> bindPose(numBones);
+    for (unsigned int i = 0; i < numBones; i++) {
+        bindPose[i] = bones[i]->mTransformation;
+        if (parents[i] >= 0) {
+            bindPose[i] = bindPose[parents[i]] * bindPose[i];
+        }
+    }
+    
+    ofSeedRandom(1);
+    built->mNumMeshes = numMeshes;
+    built->mMeshes = new aiMesh*[numMeshes];
+    for (unsigned int m = 0; m < numMeshes; m++) {
+        aiMesh* mesh = new aiMesh();
+        built->mMeshes[m] = mesh;
+        mesh->mNumVertices = numVertices;
+        mesh->mVertices = new aiVector3D[numVertices];
+        mesh->mNormals = new aiVector3D[numVertices];
+        
+        // Each vertex sits near its first bone, and is weighted to that
+        // bone and up to three after it.
+        std::vector<unsigned int> firstBone(numVertices);
+        std::vector<unsigned int> numWeights(numBones, 0);
+        for (unsigned int v = 0; v < numVertices; v++) {
+            firstBone[v] = (v * 31 + m * 7) % numBones;
+            aiVector3D offset(ofRandom(-5.f, 5.f), ofRandom(0.f, kBoneLength), ofRandom(-5.f, 5.f));
+            const aiMatrix4x4& bone = bindPose[firstBone[v]];
+            mesh->mVertices[v] = bone * offset;
+            mesh->mNormals[v] = aiVector3D(ofRandom(-1.f, 1.f), ofRandom(-1.f, 1.f), ofRandom(-1.f, 1.f)).Normalize();
+            for (int k = 0; k < GetNumInfluences(v); k++) {
+                numWeights[(firstBone[v] + k) % numBones]++;
+            }
+        }
+        
+        mesh->mNumBones = numBones;
+        mesh->mBones = new aiBone*[numBones];
+        for (unsigned int b = 0; b < numBones; b++) {
+            aiBone* bone = new aiBone();
+            bone->mName = bones[b]->mName;
+            bone->mOffsetMatrix = bindPose[b];
+            bone->mOffsetMatrix.Inverse();
+            bone->mWeights = new aiVertexWeight[numWeights[b]];
+            mesh->mBones[b] = bone;
+        }
+        for (unsigned int v = 0; v < numVertices; v++) {
+            int numInfluences = GetNumInfluences(v);
+            float total = 0.f;
+            for (int k = 0; k < numInfluences; k++) {
+                total += kWeights[k];
+            }
+            for (int k = 0; k < numInfluences; k++) {
+                aiBone* bone = mesh->mBones[(firstBone[v] + k) % numBones];
+                bone->mWeights[bone->mNumWeights++] = aiVertexWeight(v, kWeights[k] / total);
+            }
+        }
+    }
+    scene = shared_ptr<const aiScene>(built);
+    
+    // The same setup a loaded model gets, minus GL.
+    modelMeshes.resize(numMeshes);
+    for (unsigned int m = 0; m < numMeshes; m++) {
+        modelMeshes[m].mesh = built->mMeshes[m];
+        modelMeshes[m].animatedPos.resize(numVertices);
+        modelMeshes[m].animatedNorm.resize(numVertices);
+    }
+    buildSkeleton();
+}
+
+void SyntheticSkeleton::Pose(float time)
+{
+    for (size_t i = 0; i < bones.size(); i++) {
+        aiMatrix4x4 offset, bendZ, bendX;
+        aiMatrix4x4::Translation(aiVector3D(0.f, (i == 0) ? 0.f : kBoneLength, 0.f), offset);
+        aiMatrix4x4::RotationZ(0.3f * sinf(time * 2.f + i), bendZ);
+        aiMatrix4x4::RotationX(0.2f * sinf(time * 3.f + i * 0.5f), bendX);
+        bones[i]->mTransformation = offset * bendZ * bendX;
+    }
+}
+
+void SyntheticSkeleton::Skin()
+{
+    updateBones();
+}
+
+std::vector<ofxAssimpMeshHelper>& SyntheticSkeleton::GetMeshes()
+{
+    return modelMeshes;
+}
+
+unsigned int SyntheticSkeleton::GetNumBones()
+{
+    return bones.size();
+}
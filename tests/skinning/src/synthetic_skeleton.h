@@ -0,0 +1,32 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ofxAssimpModelLoader.h"
+
+/* A skinned model built in memory, so skinning can be timed and checked
+ * without a model file or a window. The skeleton is a binary tree of
+ * |numBones| bones under a root node; each of the |numMeshes| meshes has
+ * |numVertices| vertices, each weighted to 1 to 4 neighbouring bones. */
+class SyntheticSkeleton : public ofxAssimpModelLoader
+{
+public:
+    SyntheticSkeleton(unsigned int numBones, unsigned int numMeshes, unsigned int numVertices);
+    
+    /* Sets every bone's local transform for animation time |time|, in
+     * seconds. The bind pose is time 0. */
+    void Pose(float time);
+    
+    /* Skins every mesh for the current pose through updateBones(). */
+    void Skin();
+    
+    /* Gets the mesh helpers, whose animatedPos / animatedNorm hold the
+     * result of the last skinning. */
+    std::vector<ofxAssimpMeshHelper>& GetMeshes();
+    
+    unsigned int GetNumBones();
+    
+private:
+    /* Bone nodes in creation order; a bone's parent always comes first. */
+    std::vector<aiNode*> bones;
+    std::vector<int> parents;
+};